@@ -3,7 +3,13 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
-#include "Renderer/Renderer.h"
+#include <chrono>
+
+#include "Core/System/JobSystem.h"
+#include "Core/System/Profiler.h"
+#include "Renderer/GLRenderer.h"
+#include "Renderer/NullRenderer.h"
+#include "Renderer/RecordingRenderer.h"
 #include "ResourceManager/ResourceManager.h"
 #include "Scene/Scene.h"
 
@@ -11,14 +17,58 @@ namespace VSEngine {
 
 void MouseCallbacks(GLFWwindow* window, double xPos, double yPos);
 void ScrollCallback(GLFWwindow* window, double xOffset, double yOffset);
+void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+namespace {
+// Camera movement speed in world units per second.
+constexpr float cameraSpeed = 20.0f;
+// Seconds between two prints of the profiler statistics.
+constexpr double profilerPrintPeriod = 2.0;
+// Yaw of the headless camera per step in RotateCamera units, a full turn takes 400 steps.
+constexpr float headlessYawStep = 30.0f;
+
+double GetTimeSeconds()
+{
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point startTime = Clock::now();
+
+    return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+}
 
 Engine::~Engine()
 {
     Shutdown();
 }
 
-void Engine::Initialize()
+void Engine::Initialize(RendererType rendererType)
 {
+    m_pJobSystem = new System::JobSystem();
+
+    m_pProfiler = new System::Profiler();
+    m_pProfiler->SetEnabled(m_appInfo.profiling || !m_appInfo.traceFilePath.empty());
+    m_pProfiler->SetTraceCapture(!m_appInfo.traceFilePath.empty());
+
+    if (rendererType != RendererType::OpenGL)
+    {
+        m_appInfo.headless = true;
+
+        if (rendererType == RendererType::Recording)
+        {
+            m_pRenderer = new RecordingRenderer();
+        }
+        else
+        {
+            m_pRenderer = new NullRenderer();
+        }
+    }
+
+    if (m_appInfo.headless)
+    {
+        m_pResourceManager = new Resource::ResourceManager();
+        return;
+    }
+
     glfwInit();
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, m_appInfo.majorVersion);
@@ -42,9 +92,16 @@ void Engine::Initialize()
 
     glfwSetCursorPosCallback(m_pWindow, MouseCallbacks);
     glfwSetScrollCallback(m_pWindow, ScrollCallback);
+    glfwSetFramebufferSizeCallback(m_pWindow, FramebufferSizeCallback);
     glfwSetInputMode(m_pWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    m_pRenderer = new Renderer();
+    GLRenderer* pRenderer = new GLRenderer();
+    pRenderer->SetMultiDrawIndirect(m_appInfo.multiDrawIndirect);
+    pRenderer->SetDepthPrepass(m_appInfo.depthPrepass);
+    pRenderer->SetShaderHotReload(m_appInfo.shaderHotReload);
+    pRenderer->SetShaderCacheDirectory(m_appInfo.shaderCacheDirectory);
+    pRenderer->SetTextureStreaming(m_appInfo.textureStreaming, m_appInfo.textureBudget);
+    m_pRenderer = pRenderer;
     m_pResourceManager = new Resource::ResourceManager();
 }
 
@@ -56,12 +113,22 @@ void Engine::Shutdown()
     delete m_pRenderer;
     m_pRenderer = nullptr;
 
+    delete m_pJobSystem;
+    m_pJobSystem = nullptr;
+
+    delete m_pProfiler;
+    m_pProfiler = nullptr;
+
     if (m_pWindow)
     {
         glfwDestroyWindow(m_pWindow);
+        m_pWindow = nullptr;
     }
 
-    glfwTerminate();
+    if (!m_appInfo.headless)
+    {
+        glfwTerminate();
+    }
 }
 
 void Engine::Start()
@@ -81,11 +148,18 @@ void Engine::Start()
     constexpr glm::mat3 edgeDetectionKernel(1, 1, 1,
                                             1, -8, 1,
                                             1, 1, 1);
-    m_pRenderer->RenderStart();
-    // NOTE: Apply postprocess like here.
-    //m_pRenderer->SetPostProcessShader("Postprocess/KernelPostprocess.vs.glsl", "Postprocess/KernelPostprocess.fs.glsl");
-    //m_pRenderer->ApplyPostprocess(true);
-    //m_pRenderer->SetPostprocessKernel(edgeSharperKernel);
+    if (m_pRenderer)
+    {
+        m_pRenderer->RenderStart();
+    }
+    // NOTE: Apply postprocess like here. Effects are chained in the order they are added.
+    //m_pRenderer->AddPostprocessEffect("Postprocess/KernelPostprocess.vs.glsl", "Postprocess/KernelPostprocess.fs.glsl",
+    //                                  edgeSharperKernel);
+    //m_pRenderer->AddPostprocessEffect("Postprocess/KernelPostprocess.vs.glsl", "Postprocess/KernelPostprocess.fs.glsl",
+    //                                  blurKernel);
+    // Kernels of any odd size go through AddConvolutionEffect, e.g. a 5x5 box blur runs as two 1D passes:
+    //std::vector<float> boxBlurKernel(25, 1.0f / 25.0f);
+    //m_pRenderer->AddConvolutionEffect(boxBlurKernel.data(), 5);
     // ~NOTE
 
     m_pScene->Load();
@@ -93,35 +167,32 @@ void Engine::Start()
 
 void Engine::Execute()
 {
-    Camera& camera = m_pScene->GetCamera();
+    m_pScene->GetCamera().SetSpeed(static_cast<float>(m_updateScheduler.GetFixedTimeStep()) * cameraSpeed);
+    m_updateScheduler.Reset();
 
-    bool running = true;
-    double prevTime = 0;
-    do
+    if (m_appInfo.headless)
     {
-        m_pScene->UpdateScene();
-        const double time = glfwGetTime();
-
-        const float delta = static_cast<float>(time - prevTime);
-        m_pScene->GetCamera().SetSpeed(delta * 20.0f);
-        prevTime = time;
-
-        ProcessKeyInput();
-
-        m_pRenderer->Render(time, m_pScene, camera.GetProjectionMatrix());
-
-        glfwSwapBuffers(m_pWindow);
-        glfwPollEvents();
+        ExecuteHeadless();
+    }
+    else
+    {
+        ExecuteWindowed();
+    }
 
-        running &= (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_RELEASE);
-        running &= (glfwWindowShouldClose(m_pWindow) != GL_TRUE);
-    } while (running);
+    if (!m_appInfo.traceFilePath.empty() && m_pProfiler->ExportChromeTrace(m_appInfo.traceFilePath.c_str()))
+    {
+        printf("Profiler trace is written to %s\n", m_appInfo.traceFilePath.c_str());
+    }
 }
 
 void Engine::Finish()
 {
     m_pScene->Unload();
-    m_pRenderer->RenderFinish();
+
+    if (m_pRenderer)
+    {
+        m_pRenderer->RenderFinish();
+    }
 }
 
 Engine& Engine::GetEngine()
@@ -166,6 +237,75 @@ const char* Engine::GetTitle() const
     return m_appInfo.title.c_str();
 }
 
+void Engine::SetHeadless(bool headless)
+{
+    m_appInfo.headless = headless;
+}
+
+bool Engine::IsHeadless() const
+{
+    return m_appInfo.headless;
+}
+
+GLFWwindow* Engine::GetWindow() const
+{
+    return m_pWindow;
+}
+
+void Engine::SetHeadlessStepCount(unsigned int stepCount)
+{
+    m_appInfo.headlessStepCount = stepCount;
+}
+
+void Engine::SetMultiDrawIndirect(bool enable)
+{
+    m_appInfo.multiDrawIndirect = enable;
+}
+
+void Engine::SetDepthPrepass(bool enable)
+{
+    m_appInfo.depthPrepass = enable;
+}
+
+void Engine::SetShaderHotReload(bool enable)
+{
+    m_appInfo.shaderHotReload = enable;
+}
+
+void Engine::SetShaderCacheDirectory(const char* szDirectory)
+{
+    if (szDirectory && szDirectory[0] != '\0')
+    {
+        m_appInfo.shaderCacheDirectory = szDirectory;
+    }
+}
+
+void Engine::SetTextureStreaming(bool enable, size_t budget)
+{
+    m_appInfo.textureStreaming = enable;
+    m_appInfo.textureBudget = budget;
+}
+
+void Engine::SetProfiling(bool enable)
+{
+    m_appInfo.profiling = enable;
+}
+
+void Engine::SetTraceFilePath(const char* szFilePath)
+{
+    m_appInfo.traceFilePath = szFilePath ? szFilePath : "";
+}
+
+void Engine::SetFixedTimeStep(double fixedTimeStep)
+{
+    m_updateScheduler.SetFixedTimeStep(fixedTimeStep);
+}
+
+double Engine::GetFixedTimeStep() const
+{
+    return m_updateScheduler.GetFixedTimeStep();
+}
+
 void Engine::SetScene(Scene* pScene)
 {
     delete m_pScene;
@@ -182,6 +322,16 @@ Renderer* Engine::GetRenderer()
     return m_pRenderer;
 }
 
+System::JobSystem* Engine::GetJobSystem()
+{
+    return m_pJobSystem;
+}
+
+System::Profiler* Engine::GetProfiler()
+{
+    return m_pProfiler;
+}
+
 void Engine::ProcessKeyInput()
 {
     if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
@@ -210,6 +360,101 @@ void Engine::ProcessKeyInput()
     }
 }
 
+void Engine::ExecuteWindowed()
+{
+    const Camera& camera = m_pScene->GetCamera();
+
+    bool running = true;
+    double prevTime = GetTimeSeconds();
+    double lastPrintTime = prevTime;
+    do
+    {
+        m_pProfiler->BeginFrame();
+
+        const double time = GetTimeSeconds();
+        const unsigned int stepsCount = m_updateScheduler.Advance(time - prevTime);
+        prevTime = time;
+
+        for (unsigned int i = 0; i < stepsCount; ++i)
+        {
+            UpdateStep();
+        }
+
+        // Render state lies between the last two simulated states.
+        m_pScene->InterpolateState(m_updateScheduler.GetInterpolationFactor());
+
+        m_pRenderer->Render(time, m_pScene, camera.GetProjectionMatrix());
+
+        {
+            System::ScopedCpuTimer swapTimer(m_pProfiler, "Swap");
+            glfwSwapBuffers(m_pWindow);
+        }
+        glfwPollEvents();
+
+        m_pProfiler->EndFrame();
+
+        if (m_pProfiler->IsEnabled() && time - lastPrintTime >= profilerPrintPeriod)
+        {
+            m_pProfiler->PrintPassStatistics();
+            lastPrintTime = time;
+        }
+
+        running &= (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_RELEASE);
+        running &= (glfwWindowShouldClose(m_pWindow) != GL_TRUE);
+    } while (running);
+}
+
+void Engine::ExecuteHeadless()
+{
+    // Steps are simulated back to back: the goal is to measure the pipeline, not to pace it.
+    const unsigned int stepCount = m_appInfo.headlessStepCount;
+    const double startTime = GetTimeSeconds();
+
+    for (unsigned int step = 0; stepCount == 0 || step < stepCount; ++step)
+    {
+        m_pProfiler->BeginFrame();
+
+        UpdateStep();
+
+        // GPU-less renderer: every step is followed by a frame.
+        if (m_pRenderer)
+        {
+            m_pScene->InterpolateState(1.0f);
+            m_pRenderer->Render(GetTimeSeconds(), m_pScene, m_pScene->GetCamera().GetProjectionMatrix());
+        }
+
+        m_pProfiler->EndFrame();
+    }
+
+    const double elapsedTime = GetTimeSeconds() - startTime;
+    printf("Headless: %u steps in %.3f s (%.3f ms per step)\n",
+           stepCount, elapsedTime, stepCount ? elapsedTime * 1000.0 / stepCount : 0.0);
+
+    if (m_pProfiler->IsEnabled())
+    {
+        m_pProfiler->PrintPassStatistics();
+    }
+}
+
+void Engine::UpdateStep()
+{
+    System::ScopedCpuTimer updateTimer(m_pProfiler, "UpdateScene");
+
+    m_pScene->SaveState();
+
+    if (m_pWindow)
+    {
+        ProcessKeyInput();
+    }
+    else
+    {
+        // Headless camera turns at a fixed rate, so every step culls and records a new set of objects.
+        m_pScene->RotateCamera(headlessYawStep, 0.0f);
+    }
+
+    m_pScene->UpdateScene();
+}
+
 void MouseCallbacks(GLFWwindow* window, double xPos, double yPos)
 {
     static bool firstRun = true;
@@ -242,6 +487,29 @@ void ScrollCallback(GLFWwindow* window, double xOffset, double yOffset)
     Camera& camera = engine.GetScene()->GetCamera();
     const float newFoV = camera.GetFoV() - static_cast<float>(yOffset) * sensitivity;
     camera.SetFoV(newFoV);
+    engine.GetScene()->InvalidateViews();
+}
+
+void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+    // Minimized window has zero size, nothing is visible anyway.
+    if (width <= 0 || height <= 0)
+        return;
+
+    Engine& engine = GetEngine();
+    engine.SetViewportWidth(static_cast<unsigned short>(width));
+    engine.SetViewportHeight(static_cast<unsigned short>(height));
+
+    if (Scene* pScene = engine.GetScene())
+    {
+        pScene->GetCamera().RecalculateProjectionMatrix();
+        pScene->InvalidateViews();
+    }
+
+    if (Renderer* pRenderer = engine.GetRenderer())
+    {
+        pRenderer->ChangeViewportSize(static_cast<unsigned short>(width), static_cast<unsigned short>(height));
+    }
 }
 
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "Core/UpdateScheduler.h"
+
 struct GLFWwindow;
 
 namespace VSEngine {
@@ -10,9 +12,21 @@ namespace Resource {
 class ResourceManager;
 }
 
+namespace System {
+class JobSystem;
+class Profiler;
+}
+
 class Renderer;
 class Scene;
 
+enum class RendererType : char
+{
+    OpenGL,
+    // GPU-less backends. Engine doesn't create a window for them.
+    Null,
+    Recording
+};
 
 class Engine final
 {
@@ -24,7 +38,7 @@ public:
     Engine& operator=(const Engine& other) = delete;
     Engine& operator=(Engine&& other) = delete;
 
-    void                       Initialize();
+    void                       Initialize(RendererType rendererType = RendererType::OpenGL);
     void                       Shutdown();
 
     void                       Start();
@@ -42,16 +56,54 @@ public:
     void                       SetTitle(const char* szTitle);
     const char*                GetTitle() const;
 
+    // Headless engine has no window. With OpenGL renderer it runs the scene simulation only,
+    // with GPU-less renderers it runs the whole frame pipeline.
+    void                       SetHeadless(bool headless);
+    bool                       IsHeadless() const;
+    // nullptr for headless engine.
+    GLFWwindow*                GetWindow() const;
+    // Number of fixed steps simulated by headless Execute. Zero means run forever.
+    void                       SetHeadlessStepCount(unsigned int stepCount);
+    // Static meshes share a few big buffers and are drawn with multi-draw indirect. OpenGL renderer only,
+    // should be set before Initialize.
+    void                       SetMultiDrawIndirect(bool enable);
+    // Opaque objects are drawn to depth before shading. OpenGL renderer only, should be set before Initialize.
+    void                       SetDepthPrepass(bool enable);
+    // Shaders are recompiled when their files under Code/Shaders are saved. OpenGL renderer only,
+    // should be set before Initialize.
+    void                       SetShaderHotReload(bool enable);
+    // Compiled shader programs are cached there, ShaderCache under the root of the repository by default.
+    // OpenGL renderer only, should be set before Initialize.
+    void                       SetShaderCacheDirectory(const char* szDirectory);
+    // Large mip levels of the cooked textures are streamed in as the visible objects need them, within
+    // budget bytes of the resident levels (zero is unlimited). OpenGL renderer with bindless textures only,
+    // should be set before Initialize.
+    void                       SetTextureStreaming(bool enable, size_t budget);
+    // Profiler measures the frame passes and prints their times every few seconds.
+    // Non-empty trace file path enables profiling as well, Chrome trace is written there by Execute.
+    void                       SetProfiling(bool enable);
+    void                       SetTraceFilePath(const char* szFilePath);
+    void                       SetFixedTimeStep(double fixedTimeStep);
+    double                     GetFixedTimeStep() const;
+
     void                       SetScene(Scene* scene_);
     Scene*                     GetScene() const;
 
     Renderer*                  GetRenderer();
 
+    System::JobSystem*         GetJobSystem();
+    System::Profiler*          GetProfiler();
+
 private:
     Engine() = default;
 
     void                       ProcessKeyInput();
 
+    void                       ExecuteWindowed();
+    void                       ExecuteHeadless();
+    // Simulates single fixed step of the scene.
+    void                       UpdateStep();
+
 private:
     struct ApplicationInfo
     {
@@ -59,15 +111,29 @@ private:
         unsigned short windowWidth = 1200;
         unsigned short windowHeight = 800;
         unsigned short majorVersion = 4;
-        unsigned short minorVersion = 3;
+        unsigned short minorVersion = 4;
+        unsigned int headlessStepCount = 0;
+        bool headless = false;
+        bool multiDrawIndirect = false;
+        bool depthPrepass = false;
+        bool shaderHotReload = false;
+        std::string shaderCacheDirectory = std::string(ROOT_PATH) + "/ShaderCache";
+        bool textureStreaming = false;
+        size_t textureBudget = 0;
+        bool profiling = false;
+        std::string traceFilePath;
     };
 
     ApplicationInfo            m_appInfo;
 
+    UpdateScheduler            m_updateScheduler;
+
     GLFWwindow*                m_pWindow = nullptr;
     Scene*                     m_pScene = nullptr;
     Renderer*                  m_pRenderer = nullptr;
     Resource::ResourceManager* m_pResourceManager = nullptr;
+    System::JobSystem*         m_pJobSystem = nullptr;
+    System::Profiler*          m_pProfiler = nullptr;
 };
 
 }
@@ -0,0 +1,256 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace VSEngine {
+namespace System {
+namespace {
+constexpr size_t invalidQueueIndex = static_cast<size_t>(-1);
+
+// Queue of the worker thread which is running right now. Other threads have no own queue.
+thread_local const JobSystem* t_pOwnerSystem = nullptr;
+thread_local size_t           t_queueIndex = invalidQueueIndex;
+
+size_t GetDefaultWorkerCount()
+{
+    const size_t hardwareThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+}
+
+JobSystem::JobSystem(size_t workerCount)
+    : m_queues(workerCount != 0 ? workerCount : GetDefaultWorkerCount())
+{
+    const size_t queuesCount = m_queues.size();
+    m_maxBackgroundWorkers = std::max<size_t>(queuesCount, 2) - 1;
+    m_workers.reserve(queuesCount);
+    for (size_t i = 0; i < queuesCount; ++i)
+    {
+        m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_isRunning.store(false);
+    }
+    m_wakeCondition.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::Schedule(Job job, JobCounter& counter)
+{
+    counter.m_pendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_queues.empty())
+    {
+        // Single-core machine. Nobody to hand the job to.
+        job();
+        counter.m_pendingJobs.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    // Workers push to their own queue, other threads spread jobs over all queues.
+    const size_t queueIndex = (t_pOwnerSystem == this) ?
+        t_queueIndex : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    // Counted before the push: a thief decrements it as soon as the job is popped.
+    m_queuedJobsCount.fetch_add(1, std::memory_order_release);
+
+    WorkQueue& queue = m_queues[queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.emplace_back(std::move(job), &counter);
+    }
+
+    // Sleeping workers check the queued jobs count under this mutex, so the wake up can't be lost.
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wakeCondition.notify_one();
+}
+
+void JobSystem::ScheduleBackground(Job job, JobCounter& counter)
+{
+    counter.m_pendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_queues.empty())
+    {
+        job();
+        counter.m_pendingJobs.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    m_queuedBackgroundJobsCount.fetch_add(1, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(m_backgroundMutex);
+        m_backgroundJobs.emplace_back(std::move(job), &counter);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wakeCondition.notify_one();
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    const size_t queueIndex = (t_pOwnerSystem == this) ? t_queueIndex : 0;
+
+    while (!counter.IsDone())
+    {
+        if (!TryRunJob(queueIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batchSize,
+                            const std::function<void(size_t, size_t)>& function)
+{
+    if (count == 0)
+        return;
+
+    batchSize = std::max<size_t>(batchSize, 1);
+
+    if (m_queues.empty() || count <= batchSize)
+    {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += batchSize)
+    {
+        const size_t end = std::min(begin + batchSize, count);
+        Schedule([&function, begin, end]() { function(begin, end); }, counter);
+    }
+
+    Wait(counter);
+}
+
+void JobSystem::WorkerLoop(size_t queueIndex)
+{
+    t_pOwnerSystem = this;
+    t_queueIndex = queueIndex;
+
+    while (true)
+    {
+        if (TryRunJob(queueIndex) || TryRunBackgroundJob())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wakeCondition.wait(lock, [this]()
+        {
+            // Background jobs wake workers only while there is a free background slot.
+            return !m_isRunning.load() || m_queuedJobsCount.load(std::memory_order_acquire) != 0 ||
+                   (m_queuedBackgroundJobsCount.load(std::memory_order_acquire) != 0 &&
+                    m_runningBackgroundCount.load(std::memory_order_acquire) < m_maxBackgroundWorkers);
+        });
+
+        if (!m_isRunning.load())
+            return;
+    }
+}
+
+bool JobSystem::TryRunJob(size_t queueIndex)
+{
+    if (m_queues.empty() || m_queuedJobsCount.load(std::memory_order_acquire) == 0)
+        return false;
+
+    std::pair<Job, JobCounter*> job;
+    bool found = false;
+
+    // Own queue first: the newest job is the most likely to have its data in cache.
+    {
+        WorkQueue& ownQueue = m_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(ownQueue.mutex);
+        if (!ownQueue.jobs.empty())
+        {
+            job = std::move(ownQueue.jobs.back());
+            ownQueue.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // Steal the oldest job from the others.
+    const size_t queuesCount = m_queues.size();
+    for (size_t i = 1; i < queuesCount && !found; ++i)
+    {
+        WorkQueue& victimQueue = m_queues[(queueIndex + i) % queuesCount];
+        std::lock_guard<std::mutex> lock(victimQueue.mutex);
+        if (!victimQueue.jobs.empty())
+        {
+            job = std::move(victimQueue.jobs.front());
+            victimQueue.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    m_queuedJobsCount.fetch_sub(1, std::memory_order_relaxed);
+
+    job.first();
+    job.second->m_pendingJobs.fetch_sub(1, std::memory_order_release);
+
+    return true;
+}
+
+bool JobSystem::TryRunBackgroundJob()
+{
+    if (m_queuedBackgroundJobsCount.load(std::memory_order_acquire) == 0)
+        return false;
+
+    // Slot is taken before the pop, so no more than m_maxBackgroundWorkers jobs run at once.
+    if (m_runningBackgroundCount.fetch_add(1, std::memory_order_acq_rel) >= m_maxBackgroundWorkers)
+    {
+        m_runningBackgroundCount.fetch_sub(1, std::memory_order_acq_rel);
+        return false;
+    }
+
+    std::pair<Job, JobCounter*> job;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(m_backgroundMutex);
+        if (!m_backgroundJobs.empty())
+        {
+            job = std::move(m_backgroundJobs.front());
+            m_backgroundJobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        m_queuedBackgroundJobsCount.fetch_sub(1, std::memory_order_relaxed);
+
+        job.first();
+        job.second->m_pendingJobs.fetch_sub(1, std::memory_order_release);
+    }
+
+    m_runningBackgroundCount.fetch_sub(1, std::memory_order_acq_rel);
+
+    // Slot is free again, a sleeping worker may take the next background job.
+    if (found && m_queuedBackgroundJobsCount.load(std::memory_order_acquire) != 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wakeCondition.notify_one();
+    }
+
+    return found;
+}
+
+} // ~System
+} // ~VSEngine
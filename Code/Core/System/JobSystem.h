@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace VSEngine {
+namespace System {
+
+using Job = std::function<void()>;
+
+// Tracks how many jobs of a group are still unfinished.
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter& other) = delete;
+    JobCounter(JobCounter&& other) = delete;
+
+    JobCounter& operator=(const JobCounter& other) = delete;
+    JobCounter& operator=(JobCounter&& other) = delete;
+
+    inline bool IsDone() const { return m_pendingJobs.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<size_t> m_pendingJobs{ 0 };
+};
+
+// Work-stealing thread pool. Every worker owns a queue: it takes the newest job from
+// its own queue and steals the oldest one from other queues when its own is empty.
+class JobSystem
+{
+public:
+    // Zero worker count means "all hardware threads except the calling one".
+    JobSystem(size_t workerCount = 0);
+    JobSystem(const JobSystem& other) = delete;
+    JobSystem(JobSystem&& other) = delete;
+    ~JobSystem();
+
+    JobSystem& operator=(const JobSystem& other) = delete;
+    JobSystem& operator=(JobSystem&& other) = delete;
+
+    void          Schedule(Job job, JobCounter& counter);
+    // Long jobs like file reads and image decoding. Workers take them only when the regular queues are empty,
+    // and at least one worker is kept for the regular jobs. Wait never runs them on the calling thread,
+    // so a frame waiting for its jobs doesn't pick one up.
+    void          ScheduleBackground(Job job, JobCounter& counter);
+
+    // Calling thread runs pending regular jobs until all the jobs of the counter are finished.
+    void          Wait(const JobCounter& counter);
+
+    // Splits [0, count) into batches and runs function(begin, end) for each of them.
+    // Returns when all batches are processed.
+    void          ParallelFor(size_t count, size_t batchSize,
+                              const std::function<void(size_t, size_t)>& function);
+
+    inline size_t GetWorkerCount() const { return m_workers.size(); }
+
+private:
+    struct WorkQueue
+    {
+        std::deque<std::pair<Job, JobCounter*>> jobs;
+        std::mutex                              mutex;
+    };
+
+    void          WorkerLoop(size_t queueIndex);
+
+    // Pops a job from the own queue or steals one from the others. Returns false if there is nothing to run.
+    bool          TryRunJob(size_t queueIndex);
+    bool          TryRunBackgroundJob();
+
+private:
+    std::vector<WorkQueue>   m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex               m_sleepMutex;
+    std::condition_variable  m_wakeCondition;
+
+    std::deque<std::pair<Job, JobCounter*>> m_backgroundJobs;
+    std::mutex               m_backgroundMutex;
+    size_t                   m_maxBackgroundWorkers = 1;
+    std::atomic<size_t>      m_runningBackgroundCount{ 0 };
+
+    std::atomic<size_t>      m_queuedJobsCount{ 0 };
+    std::atomic<size_t>      m_queuedBackgroundJobsCount{ 0 };
+    std::atomic<size_t>      m_nextQueue{ 0 };
+    std::atomic<bool>        m_isRunning{ true };
+};
+
+} // ~System
+} // ~VSEngine
@@ -0,0 +1,205 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace VSEngine {
+namespace System {
+namespace {
+constexpr uint32_t gpuThreadId = 0;
+
+int64_t GetClockNanoseconds()
+{
+    using Clock = std::chrono::steady_clock;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+}
+
+Profiler::Profiler()
+    : m_startTime(GetClockNanoseconds())
+{}
+
+void Profiler::SetTraceCapture(bool enable)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_captureTrace = enable;
+}
+
+void Profiler::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (PassHistory& pass : m_passes)
+    {
+        pass.frameCpuTime = 0.0;
+        pass.frameGpuTime = 0.0;
+    }
+}
+
+void Profiler::EndFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const size_t historyIndex = m_frameIndex % historyFramesCount;
+    for (PassHistory& pass : m_passes)
+    {
+        pass.cpuTimes[historyIndex] = pass.frameCpuTime;
+        pass.gpuTimes[historyIndex] = pass.frameGpuTime;
+    }
+
+    ++m_frameIndex;
+    m_recordedFramesCount = std::min(m_recordedFramesCount + 1, historyFramesCount);
+}
+
+double Profiler::GetTime() const
+{
+    return static_cast<double>(GetClockNanoseconds() - m_startTime) / 1000.0;
+}
+
+void Profiler::AddCpuSample(const char* name, double startTime, double duration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    GetPassHistory(name).frameCpuTime += duration / 1000.0;
+
+    if (m_captureTrace)
+    {
+        AddTraceEvent(name, startTime, duration, GetThreadId(std::this_thread::get_id()));
+    }
+}
+
+void Profiler::AddGpuSample(const char* name, double startTime, double duration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    GetPassHistory(name).frameGpuTime += duration / 1000.0;
+
+    if (m_captureTrace)
+    {
+        AddTraceEvent(name, startTime, duration, gpuThreadId);
+    }
+}
+
+void Profiler::GetPassStatistics(std::vector<PassStatistics>& statistics) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    statistics.clear();
+    if (m_recordedFramesCount == 0)
+        return;
+
+    for (const PassHistory& pass : m_passes)
+    {
+        PassStatistics& passStatistics = statistics.emplace_back();
+        passStatistics.name = pass.name;
+
+        for (size_t i = 0; i < m_recordedFramesCount; ++i)
+        {
+            passStatistics.cpuTime += pass.cpuTimes[i];
+            passStatistics.maxCpuTime = std::max(passStatistics.maxCpuTime, pass.cpuTimes[i]);
+            passStatistics.gpuTime += pass.gpuTimes[i];
+            passStatistics.maxGpuTime = std::max(passStatistics.maxGpuTime, pass.gpuTimes[i]);
+        }
+
+        passStatistics.cpuTime /= static_cast<double>(m_recordedFramesCount);
+        passStatistics.gpuTime /= static_cast<double>(m_recordedFramesCount);
+    }
+}
+
+void Profiler::PrintPassStatistics() const
+{
+    std::vector<PassStatistics> statistics;
+    GetPassStatistics(statistics);
+
+    printf("%-16s %10s %10s %10s %10s\n", "Pass", "CPU ms", "CPU max", "GPU ms", "GPU max");
+    for (const PassStatistics& pass : statistics)
+    {
+        printf("%-16s %10.3f %10.3f %10.3f %10.3f\n", pass.name.c_str(),
+               pass.cpuTime, pass.maxCpuTime, pass.gpuTime, pass.maxGpuTime);
+    }
+}
+
+bool Profiler::ExportChromeTrace(const char* szFilePath) const
+{
+    FILE* pFile = fopen(szFilePath, "w");
+    if (pFile == nullptr)
+    {
+        fprintf(stderr, "Can't open trace file %s\n", szFilePath);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    fprintf(pFile, "{\"traceEvents\":[\n");
+    fprintf(pFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}",
+            gpuThreadId);
+
+    for (const auto& threadPair : m_threadIds)
+    {
+        fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+                threadPair.second, threadPair.second);
+    }
+
+    for (const TraceEvent& event : m_traceEvents)
+    {
+        fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                event.name, event.threadId == gpuThreadId ? "GPU" : "CPU", event.startTime, event.duration,
+                event.threadId);
+    }
+
+    fprintf(pFile, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(pFile);
+
+    return true;
+}
+
+Profiler::PassHistory& Profiler::GetPassHistory(const char* name)
+{
+    // There are a few passes, linear search is cheaper than hashing the name.
+    for (PassHistory& pass : m_passes)
+    {
+        if (std::strcmp(pass.name.c_str(), name) == 0)
+            return pass;
+    }
+
+    PassHistory& pass = m_passes.emplace_back();
+    pass.name = name;
+
+    return pass;
+}
+
+uint32_t Profiler::GetThreadId(std::thread::id threadId)
+{
+    auto insertResult = m_threadIds.try_emplace(threadId, static_cast<uint32_t>(m_threadIds.size() + 1));
+    return insertResult.first->second;
+}
+
+void Profiler::AddTraceEvent(const char* name, double startTime, double duration, uint32_t threadId)
+{
+    if (m_traceEvents.size() >= maxTraceEventsCount)
+        return;
+
+    m_traceEvents.push_back({ name, startTime, duration, threadId });
+}
+
+ScopedCpuTimer::ScopedCpuTimer(Profiler* pProfiler, const char* name)
+{
+    if (pProfiler == nullptr || !pProfiler->IsEnabled())
+        return;
+
+    m_pProfiler = pProfiler;
+    m_name = name;
+    m_startTime = pProfiler->GetTime();
+}
+
+ScopedCpuTimer::~ScopedCpuTimer()
+{
+    if (m_pProfiler == nullptr)
+        return;
+
+    m_pProfiler->AddCpuSample(m_name, m_startTime, m_pProfiler->GetTime() - m_startTime);
+}
+
+} // ~System
+} // ~VSEngine
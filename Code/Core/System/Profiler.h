@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace VSEngine {
+namespace System {
+
+// Average times of a pass over the last frames, in milliseconds.
+struct PassStatistics
+{
+    std::string name;
+    double      cpuTime = 0.0;
+    double      maxCpuTime = 0.0;
+    double      gpuTime = 0.0;
+    double      maxGpuTime = 0.0;
+};
+
+// Collects CPU and GPU times of named passes. Times of a frame are summed per pass and kept
+// for the last historyFramesCount frames. While trace capture is on every sample is stored
+// as well and can be exported in Chrome trace format (chrome://tracing, Perfetto).
+// Pass names are expected to be string literals: trace events keep the pointers.
+class Profiler
+{
+public:
+    static constexpr size_t historyFramesCount = 120;
+    // Trace capture stops silently when this many events are stored.
+    static constexpr size_t maxTraceEventsCount = 1 << 20;
+
+    Profiler();
+    Profiler(const Profiler& other) = delete;
+    Profiler(Profiler&& other) = delete;
+
+    Profiler& operator=(const Profiler& other) = delete;
+    Profiler& operator=(Profiler&& other) = delete;
+
+    void   SetEnabled(bool enable) { m_isEnabled = enable; }
+    bool   IsEnabled() const { return m_isEnabled; }
+
+    void   SetTraceCapture(bool enable);
+
+    void   BeginFrame();
+    void   EndFrame();
+
+    // Microseconds since the profiler creation.
+    double GetTime() const;
+
+    // Thread safe. Start and duration are in microseconds.
+    void   AddCpuSample(const char* name, double startTime, double duration);
+    // GPU results arrive some frames later, they are accounted to the frame they are reported in.
+    // Start time is the CPU time the pass was submitted at.
+    void   AddGpuSample(const char* name, double startTime, double duration);
+
+    void   GetPassStatistics(std::vector<PassStatistics>& statistics) const;
+    void   PrintPassStatistics() const;
+
+    bool   ExportChromeTrace(const char* szFilePath) const;
+
+private:
+    struct PassHistory
+    {
+        std::string name;
+        double      frameCpuTime = 0.0;
+        double      frameGpuTime = 0.0;
+        double      cpuTimes[historyFramesCount] = {};
+        double      gpuTimes[historyFramesCount] = {};
+    };
+
+    struct TraceEvent
+    {
+        const char* name = nullptr;
+        double      startTime = 0.0;
+        double      duration = 0.0;
+        // Zero is the GPU timeline, CPU threads start from one.
+        uint32_t    threadId = 0;
+    };
+
+    // Should be called under m_mutex.
+    PassHistory& GetPassHistory(const char* name);
+    uint32_t     GetThreadId(std::thread::id threadId);
+    void         AddTraceEvent(const char* name, double startTime, double duration, uint32_t threadId);
+
+private:
+    mutable std::mutex                            m_mutex;
+
+    std::vector<PassHistory>                      m_passes;
+    size_t                                        m_frameIndex = 0;
+    size_t                                        m_recordedFramesCount = 0;
+
+    std::vector<TraceEvent>                       m_traceEvents;
+    std::unordered_map<std::thread::id, uint32_t> m_threadIds;
+
+    int64_t                                       m_startTime = 0;
+    bool                                          m_isEnabled = false;
+    bool                                          m_captureTrace = false;
+};
+
+// Measures CPU time of the enclosing scope. Does nothing if profiler is null or disabled.
+class ScopedCpuTimer
+{
+public:
+    ScopedCpuTimer(Profiler* pProfiler, const char* name);
+    ~ScopedCpuTimer();
+
+    ScopedCpuTimer(const ScopedCpuTimer& other) = delete;
+    ScopedCpuTimer& operator=(const ScopedCpuTimer& other) = delete;
+
+private:
+    Profiler*   m_pProfiler = nullptr;
+    const char* m_name = nullptr;
+    double      m_startTime = 0.0;
+};
+
+} // ~System
+} // ~VSEngine
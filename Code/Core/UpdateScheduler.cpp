@@ -0,0 +1,53 @@
+#include "UpdateScheduler.h"
+
+namespace VSEngine {
+
+UpdateScheduler::UpdateScheduler(double fixedTimeStep, unsigned int maxStepsPerFrame)
+    : m_fixedTimeStep(fixedTimeStep > 0.0 ? fixedTimeStep : defaultFixedTimeStep)
+    , m_maxStepsPerFrame(maxStepsPerFrame)
+{}
+
+void UpdateScheduler::SetFixedTimeStep(double fixedTimeStep)
+{
+    if (fixedTimeStep <= 0.0)
+        return;
+
+    m_fixedTimeStep = fixedTimeStep;
+    m_accumulator = 0.0;
+}
+
+unsigned int UpdateScheduler::Advance(double frameTime)
+{
+    if (frameTime > 0.0)
+    {
+        m_accumulator += frameTime;
+    }
+
+    unsigned int steps = 0;
+    while (m_accumulator >= m_fixedTimeStep)
+    {
+        m_accumulator -= m_fixedTimeStep;
+        ++steps;
+    }
+
+    if (steps > m_maxStepsPerFrame)
+    {
+        // Simulation can't keep up. Drop the time instead of accumulating the debt.
+        steps = m_maxStepsPerFrame;
+        m_accumulator = 0.0;
+    }
+
+    return steps;
+}
+
+float UpdateScheduler::GetInterpolationFactor() const
+{
+    return static_cast<float>(m_accumulator / m_fixedTimeStep);
+}
+
+void UpdateScheduler::Reset()
+{
+    m_accumulator = 0.0;
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace VSEngine {
+
+constexpr double defaultFixedTimeStep = 1.0 / 60.0;
+constexpr unsigned int defaultMaxStepsPerFrame = 8;
+
+// Accumulates real frame time and converts it into a number of fixed simulation steps.
+// The remainder is exposed as interpolation factor between the last two simulated states.
+class UpdateScheduler final
+{
+public:
+    UpdateScheduler(double fixedTimeStep = defaultFixedTimeStep,
+                    unsigned int maxStepsPerFrame = defaultMaxStepsPerFrame);
+
+    void         SetFixedTimeStep(double fixedTimeStep);
+    double       GetFixedTimeStep() const { return m_fixedTimeStep; }
+
+    // Returns the number of fixed steps which should be simulated for the frame.
+    unsigned int Advance(double frameTime);
+
+    // Position of the rendered frame between previous and current simulated states, [0, 1).
+    float        GetInterpolationFactor() const;
+
+    void         Reset();
+
+private:
+    double       m_fixedTimeStep;
+    double       m_accumulator = 0.0;
+    // Protects from the spiral of death when simulation is slower than real time.
+    unsigned int m_maxStepsPerFrame;
+};
+
+}
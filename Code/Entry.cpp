@@ -12,13 +12,52 @@
 #include <string>
 #include <vector>
 
+#include <cctype>
 #include <chrono>
+#include <cstdlib>
 #include <random>
 
-void Process()
+// Scatters point lights of random colors over the scene to stress the clustered lighting.
+void AddRandomPointLights(VSEngine::Scene* pScene, unsigned int count)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> horizontalDistribution(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> verticalDistribution(0.0f, 30.0f);
+    std::uniform_real_distribution<float> colorDistribution(0.2f, 1.0f);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        VSEngine::Light light;
+        light.SetLightType(VSEngine::LightType::Point);
+        light.SetPosition(glm::vec3(horizontalDistribution(generator), verticalDistribution(generator),
+                                    horizontalDistribution(generator)));
+        light.SetColor(glm::vec3(colorDistribution(generator), colorDistribution(generator),
+                                 colorDistribution(generator)));
+        light.SetAmbient(glm::vec3(0.0f));
+        light.SetDiffuse(glm::vec3(0.8f));
+        light.SetSpecular(glm::vec3(0.5f));
+        // Range of about 30 units.
+        light.SetAttenuationParamenters(1.0f, 0.14f, 0.07f);
+
+        pScene->AddLight(light);
+    }
+}
+
+void Process(bool headless, unsigned int headlessStepCount, bool multiDrawIndirect, bool depthPrepass,
+             bool shaderHotReload, const char* szShaderCacheDirectory, bool textureStreaming, size_t textureBudget,
+             bool profiling, const char* szTraceFilePath, unsigned int pointLightsCount)
 {
     VSEngine::Engine& engine = GetEngine();
-    engine.Initialize();
+    engine.SetHeadless(headless);
+    engine.SetHeadlessStepCount(headlessStepCount);
+    engine.SetMultiDrawIndirect(multiDrawIndirect);
+    engine.SetDepthPrepass(depthPrepass);
+    engine.SetShaderHotReload(shaderHotReload);
+    engine.SetShaderCacheDirectory(szShaderCacheDirectory);
+    engine.SetTextureStreaming(textureStreaming, textureBudget);
+    engine.SetProfiling(profiling);
+    engine.SetTraceFilePath(szTraceFilePath);
+    engine.Initialize(headless ? VSEngine::RendererType::Null : VSEngine::RendererType::OpenGL);
 
     VSEngine::Scene* pScene = new VSEngine::Scene();
     engine.SetScene(pScene);
@@ -86,6 +125,8 @@ void Process()
 
     pScene->SetCamera(cam);
 
+    AddRandomPointLights(pScene, pointLightsCount);
+
     engine.Start();
     engine.Execute();
     engine.Finish();
@@ -93,9 +134,72 @@ void Process()
     engine.Shutdown();
 }
 
-int main()
+// Usage: VSEngine [--headless [stepCount]] [--multidraw] [--depthprepass] [--hotreload] [--shadercache directory]
+//                 [--streaming [budgetMegabytes]] [--profile] [--trace file.json] [--lights pointLightsCount]
+int main(int argc, char** argv)
 {
-    Process();
+    bool headless = false;
+    unsigned int headlessStepCount = 0;
+    bool multiDrawIndirect = false;
+    bool depthPrepass = false;
+    bool shaderHotReload = false;
+    const char* szShaderCacheDirectory = nullptr;
+    bool textureStreaming = false;
+    size_t textureBudget = 0;
+    bool profiling = false;
+    const char* szTraceFilePath = nullptr;
+    unsigned int pointLightsCount = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        if (argument == "--headless")
+        {
+            headless = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                headlessStepCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            }
+        }
+        else if (argument == "--multidraw")
+        {
+            multiDrawIndirect = true;
+        }
+        else if (argument == "--depthprepass")
+        {
+            depthPrepass = true;
+        }
+        else if (argument == "--hotreload")
+        {
+            shaderHotReload = true;
+        }
+        else if (argument == "--shadercache" && i + 1 < argc)
+        {
+            szShaderCacheDirectory = argv[++i];
+        }
+        else if (argument == "--streaming")
+        {
+            textureStreaming = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+            {
+                textureBudget = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10)) * 1024 * 1024;
+            }
+        }
+        else if (argument == "--profile")
+        {
+            profiling = true;
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            szTraceFilePath = argv[++i];
+        }
+        else if (argument == "--lights" && i + 1 < argc)
+        {
+            pointLightsCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+
+    Process(headless, headlessStepCount, multiDrawIndirect, depthPrepass, shaderHotReload, szShaderCacheDirectory,
+            textureStreaming, textureBudget, profiling, szTraceFilePath, pointLightsCount);
 
     return 0;
 }
\ No newline at end of file
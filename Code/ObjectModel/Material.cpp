@@ -15,6 +15,7 @@ Material::Material(const Material& mat)
     , m_diffuse(mat.m_diffuse)
     , m_specular(mat.m_specular)
     , m_shininess(mat.m_shininess)
+    , m_opacity(mat.m_opacity)
 {}
 
 Material::Material(Material&& mat) noexcept
@@ -23,6 +24,7 @@ Material::Material(Material&& mat) noexcept
     , m_diffuse(mat.m_diffuse)
     , m_specular(mat.m_specular)
     , m_shininess(mat.m_shininess)
+    , m_opacity(mat.m_opacity)
 {}
 
 Material::~Material()
@@ -38,6 +40,7 @@ Material& Material::operator=(const Material& mat)
         m_diffuse = mat.m_diffuse;
         m_specular = mat.m_specular;
         m_shininess = mat.m_shininess;
+        m_opacity = mat.m_opacity;
     }
 
     return *this;
@@ -52,6 +55,7 @@ Material& Material::operator=(Material&& mat) noexcept
         m_diffuse = mat.m_diffuse;
         m_specular = mat.m_specular;
         m_shininess = mat.m_shininess;
+        m_opacity = mat.m_opacity;
     }
 
     return *this;
@@ -116,6 +120,21 @@ float Material::GetShininess() const
     return m_shininess;
 }
 
+void Material::SetOpacity(float opacity)
+{
+    m_opacity = opacity;
+}
+
+float Material::GetOpacity() const
+{
+    return m_opacity;
+}
+
+bool Material::IsTransparent() const
+{
+    return m_opacity < 1.0f;
+}
+
 const char* Material::GetMaterialName() const
 {
     return m_materialName.c_str();
@@ -54,6 +54,11 @@ public:
     void             SetShininess(float shininess);
     float            GetShininess() const;
 
+    // Materials with opacity below one are blended and drawn after the opaque ones.
+    void             SetOpacity(float opacity);
+    float            GetOpacity() const;
+    bool             IsTransparent() const;
+
     const char*      GetMaterialName() const;
 
 private:
@@ -66,6 +71,7 @@ private:
     std::string           m_materialName;
 
     float                 m_shininess = 32.0f;
+    float                 m_opacity = 1.0f;
 };
 
 #define Emerald Material(glm::vec3(0.0215f, 0.1745f, 0.0215f), \
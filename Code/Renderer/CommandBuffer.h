@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace VSEngine {
+
+enum class CommandType : uint32_t
+{
+    BindUniformBlock,
+    BindVertexArray,
+    BindInstances,
+    BindTexture,
+    UseMaterialVariant,
+    DrawInstanced
+};
+
+// Object names are GL names, but nothing here calls GL.
+struct BindUniformBlockCommand
+{
+    static constexpr CommandType type = CommandType::BindUniformBlock;
+    uint32_t binding = 0;
+    uint32_t buffer = 0;
+    uint32_t offset = 0;
+    uint32_t size = 0;
+};
+
+struct BindVertexArrayCommand
+{
+    static constexpr CommandType type = CommandType::BindVertexArray;
+    uint32_t vertexArray = 0;
+};
+
+// Instances of the following draws start from firstInstance of the frame instance buffer.
+struct BindInstancesCommand
+{
+    static constexpr CommandType type = CommandType::BindInstances;
+    uint32_t firstInstance = 0;
+};
+
+struct BindTextureCommand
+{
+    static constexpr CommandType type = CommandType::BindTexture;
+    uint32_t unit = 0;
+    uint32_t texture = 0;
+};
+
+// Program of the material variant is taken from the programs of the pass which replays the buffer,
+// so the same commands serve the depth pre-pass and the shading pass.
+struct UseMaterialVariantCommand
+{
+    static constexpr CommandType type = CommandType::UseMaterialVariant;
+    uint32_t variant = 0;
+};
+
+// firstIndex and baseVertex are non-zero for meshes of the geometry pool.
+struct DrawInstancedCommand
+{
+    static constexpr CommandType type = CommandType::DrawInstanced;
+    uint32_t indicesCount = 0;
+    uint32_t instancesCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t  baseVertex = 0;
+};
+
+// Linear buffer of render commands, each stored as its type followed by its data.
+// Recording doesn't call GL, so buffers can be filled on worker threads (one buffer per thread)
+// and replayed on the thread which owns the context. Reset keeps the memory for the next frame.
+class CommandBuffer
+{
+public:
+    void   Reset()
+    {
+        m_data.clear();
+        m_commandsCount = 0;
+    }
+
+    template<typename Command>
+    void   Record(const Command& command)
+    {
+        const CommandType type = Command::type;
+        const size_t offset = m_data.size();
+        m_data.resize(offset + sizeof(CommandType) + sizeof(Command));
+        std::memcpy(m_data.data() + offset, &type, sizeof(CommandType));
+        std::memcpy(m_data.data() + offset + sizeof(CommandType), &command, sizeof(Command));
+        ++m_commandsCount;
+    }
+
+    // Calls visitor(command) for every recorded command in the recorded order.
+    template<typename Visitor>
+    void   Execute(Visitor& visitor) const;
+
+    size_t GetCommandsCount() const { return m_commandsCount; }
+    // In bytes.
+    size_t GetSize() const { return m_data.size(); }
+    bool   IsEmpty() const { return m_data.empty(); }
+
+private:
+    template<typename Command, typename Visitor>
+    static const unsigned char* Visit(const unsigned char* pData, Visitor& visitor)
+    {
+        Command command;
+        std::memcpy(&command, pData, sizeof(Command));
+        visitor(command);
+        return pData + sizeof(Command);
+    }
+
+private:
+    std::vector<unsigned char> m_data;
+    size_t                     m_commandsCount = 0;
+};
+
+template<typename Visitor>
+void CommandBuffer::Execute(Visitor& visitor) const
+{
+    const unsigned char* pData = m_data.data();
+    const unsigned char* pEnd = pData + m_data.size();
+    while (pData < pEnd)
+    {
+        CommandType type;
+        std::memcpy(&type, pData, sizeof(CommandType));
+        pData += sizeof(CommandType);
+
+        switch (type)
+        {
+        case CommandType::BindUniformBlock:
+            pData = Visit<BindUniformBlockCommand>(pData, visitor);
+            break;
+        case CommandType::BindVertexArray:
+            pData = Visit<BindVertexArrayCommand>(pData, visitor);
+            break;
+        case CommandType::BindInstances:
+            pData = Visit<BindInstancesCommand>(pData, visitor);
+            break;
+        case CommandType::BindTexture:
+            pData = Visit<BindTextureCommand>(pData, visitor);
+            break;
+        case CommandType::UseMaterialVariant:
+            pData = Visit<UseMaterialVariantCommand>(pData, visitor);
+            break;
+        case CommandType::DrawInstanced:
+            pData = Visit<DrawInstancedCommand>(pData, visitor);
+            break;
+        default:
+            // Corrupted buffer, the size of the command is unknown.
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,1610 @@
+#include "GLRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "Core/Engine.h"
+#include "Core/System/JobSystem.h"
+#include "Core/System/Profiler.h"
+#include "Scene/Scene.h"
+#include "Scene/Components/SceneObject.h"
+#include "ObjectModel/Mesh.h"
+#include "Renderer/RenderData.h"
+#include "Renderer/ShaderPreprocessor.h"
+
+#include "glm/glm.hpp"
+
+namespace VSEngine {
+namespace {
+// Point lights are cut off where they contribute less than this.
+constexpr float lightInfluenceThreshold = 1.0f / 256.0f;
+// Storage ranges are never empty, see UploadStorageBlock.
+constexpr size_t minStorageBlockSize = 16;
+
+// Should match MAX_RADIUS of the convolution shaders.
+constexpr size_t maxSeparableKernelRadius = 32;
+constexpr size_t maxComputeKernelRadius = 8;
+// Should match TILE_SIZE of Convolution.cs.glsl.
+constexpr GLuint convolutionTileSize = 16;
+
+// Distance at which attenuated light falls below lightInfluenceThreshold:
+// quadratic * d^2 + linear * d + constant = intensity / threshold.
+float CalculateLightRadius(const PointLightBlock& light)
+{
+    const glm::vec3 maxColor = glm::max(glm::max(light.ambient, light.diffuse), light.specular);
+    const float maxIntensity = std::max(std::max(maxColor.x, maxColor.y), maxColor.z);
+
+    const float target = maxIntensity / lightInfluenceThreshold - light.constant;
+    if (target <= 0.0f)
+        return 0.0f;
+
+    if (light.quadratic > 0.0f)
+    {
+        const float discriminant = light.linear * light.linear + 4.0f * light.quadratic * target;
+        return (std::sqrt(discriminant) - light.linear) / (2.0f * light.quadratic);
+    }
+
+    if (light.linear > 0.0f)
+        return target / light.linear;
+
+    return std::numeric_limits<float>::max();
+}
+
+// Define names by the bits of MainProgramFlags.
+const std::vector<std::string> mainProgramDefines = { "HAS_DIFFUSE_MAP", "HAS_SPECULAR_MAP",
+                                                      "DIRECTIONAL_LIGHT", "POINT_LIGHTS", "FLASHLIGHT" };
+
+// Splits the kernel into column * row if its rank is one. The row and the column through
+// the largest weight span the whole kernel in that case.
+bool SeparateKernel(const float* pWeights, size_t kernelSize, std::vector<float>& column, std::vector<float>& row)
+{
+    const size_t weightsCount = kernelSize * kernelSize;
+
+    size_t pivot = 0;
+    for (size_t i = 1; i < weightsCount; ++i)
+    {
+        if (std::abs(pWeights[i]) > std::abs(pWeights[pivot]))
+        {
+            pivot = i;
+        }
+    }
+
+    const float pivotWeight = pWeights[pivot];
+    if (pivotWeight == 0.0f)
+        return false;
+
+    const size_t pivotRow = pivot / kernelSize;
+    const size_t pivotColumn = pivot % kernelSize;
+
+    column.resize(kernelSize);
+    row.resize(kernelSize);
+    for (size_t i = 0; i < kernelSize; ++i)
+    {
+        column[i] = pWeights[i * kernelSize + pivotColumn];
+        row[i] = pWeights[pivotRow * kernelSize + i] / pivotWeight;
+    }
+
+    const float tolerance = 1e-5f * std::abs(pivotWeight);
+    for (size_t i = 0; i < kernelSize; ++i)
+    {
+        for (size_t j = 0; j < kernelSize; ++j)
+        {
+            if (std::abs(column[i] * row[j] - pWeights[i * kernelSize + j]) > tolerance)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Replays recorded commands through the state cache.
+struct CommandExecutor
+{
+    GLStateCache&           stateCache;
+    const InstanceBuffer&   instanceBuffer;
+    const MaterialPrograms& programs;
+    // Draws of a variant without program are skipped.
+    bool                    hasProgram = true;
+
+    void operator()(const BindUniformBlockCommand& command)
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, command.binding, command.buffer, command.offset, command.size);
+    }
+
+    void operator()(const BindVertexArrayCommand& command)
+    {
+        stateCache.BindVertexArray(command.vertexArray);
+    }
+
+    void operator()(const BindInstancesCommand& command)
+    {
+        instanceBuffer.Bind(command.firstInstance);
+    }
+
+    void operator()(const BindTextureCommand& command)
+    {
+        stateCache.BindTexture(command.unit, GL_TEXTURE_2D, command.texture);
+    }
+
+    void operator()(const UseMaterialVariantCommand& command)
+    {
+        VSUtils::ShaderProgram* pProgram = programs[command.variant];
+        hasProgram = pProgram != nullptr;
+        if (hasProgram)
+        {
+            stateCache.UseProgram(*pProgram);
+        }
+    }
+
+    void operator()(const DrawInstancedCommand& command)
+    {
+        if (!hasProgram)
+            return;
+
+        const void* pIndices = reinterpret_cast<const void*>(command.firstIndex * sizeof(GLushort));
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(command.indicesCount), GL_UNSIGNED_SHORT,
+                                          pIndices, static_cast<GLsizei>(command.instancesCount), command.baseVertex);
+    }
+};
+}
+
+void APIENTRY GLRenderer::DebugCallback(
+    GLenum source,
+    GLenum type,
+    GLuint id,
+    GLenum severity,
+    GLsizei length,
+    const GLchar* message,
+    GLvoid* userParam)
+{
+    reinterpret_cast<GLRenderer*>(userParam)->OnDebugMessage(source, type, id, severity, length, message);
+}
+
+GLRenderer::GLRenderer()
+{
+    Initialize();
+}
+
+GLRenderer::GLRenderer(unsigned short viewportWidth, unsigned short viewportHeight)
+{
+    Initialize();
+    ChangeViewportSize(viewportWidth, viewportHeight);
+}
+
+GLRenderer::~GLRenderer()
+{
+    ClearStoredObjects();
+}
+
+void GLRenderer::ChangeViewportSize(unsigned short width, unsigned short height)
+{
+    m_viewportWidth = width;
+    m_viewportHeight = height;
+    glViewport(0, 0, width, height);
+
+    // Targets of the previous size won't be requested anymore.
+    m_renderTargetPool.Trim();
+}
+
+void GLRenderer::RenderStart()
+{
+    if (m_viewportWidth == 0 || m_viewportHeight == 0)
+    {
+        Engine& engine = GetEngine();
+        ChangeViewportSize(engine.GetViewportWidth(), engine.GetViewportHeight());
+    }
+
+    m_shaderCache.Initialize(m_shaderCacheDirectory);
+
+    m_shaderCompiler.Initialize(GetEngine().GetWindow());
+
+    // Variants are compiled in the background when the first frame needs them, placeholders are drawn meanwhile.
+    // Placeholders are small and compiled right away.
+    // Texture references of the materials are handles or array layers, see MaterialTextures.
+    VSUtils::ShaderDefines commonDefines;
+    if (m_materialTextures.IsBindless())
+    {
+        commonDefines.push_back("BINDLESS_TEXTURES");
+    }
+
+    m_mainVariants.Initialize("Main/Main.vs.glsl", "Main/Main.fs.glsl", mainProgramDefines, commonDefines,
+                              &m_shaderCache, &m_shaderCompiler);
+    m_depthPrepassVariants.Initialize("Main/Main.vs.glsl", "Main/DepthPrepass.fs.glsl", mainProgramDefines,
+                                      commonDefines, &m_shaderCache, &m_shaderCompiler);
+
+    m_placeholderShader.SetVertexShader("Main/Main.vs.glsl");
+    m_placeholderShader.SetFragmentShader("Main/Placeholder.fs.glsl");
+    m_placeholderShader.CompileProgram(&m_shaderCache);
+    m_stateCache.InvalidateProgram(m_placeholderShader.GetProgram());
+
+    // Depth pre-pass variant without alpha test.
+    m_depthPlaceholderShader.SetVertexShader("Main/Main.vs.glsl");
+    m_depthPlaceholderShader.SetFragmentShader("Main/DepthPrepass.fs.glsl");
+    m_depthPlaceholderShader.CompileProgram(&m_shaderCache);
+    m_stateCache.InvalidateProgram(m_depthPlaceholderShader.GetProgram());
+
+    lightShader.SetVertexShader("Light/Light.vs.glsl");
+    lightShader.SetFragmentShader("Light/Light.fs.glsl");
+    lightShader.CompileProgram(&m_shaderCache);
+
+    if (m_useShaderHotReload)
+    {
+        m_shaderWatcher.Initialize(VSUtils::GetShaderPath("").c_str());
+        m_shaderReloader.Initialize(&m_shaderCache, &m_shaderCompiler);
+    }
+
+    glEnable(GL_CULL_FACE);
+    glDepthFunc(GL_LESS);
+
+    // Blending is enabled for the transparent batches only.
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    InitializeBuffers();
+
+    m_pProfiler = GetEngine().GetProfiler();
+    m_gpuTimer.Initialize(m_pProfiler);
+
+    // Generate post-process data.
+    InitializePostProcessData();
+}
+
+void GLRenderer::RenderFinish()
+{
+    // Pending copies are compiled by the compiler, they go first.
+    m_shaderReloader.Uninitialize();
+    m_textureStreamer.Uninitialize();
+    m_textureUploadQueue.Uninitialize();
+    m_shaderWatcher.Uninitialize();
+    ClearPostprocessEffects();
+    UninitializePostProcessData();
+    m_mainVariants.Clear();
+    m_depthPrepassVariants.Clear();
+    m_mainPrograms = {};
+    m_depthPrepassPrograms = {};
+    m_shaderCompiler.Uninitialize();
+    UninitializeBuffers();
+    m_gpuTimer.Uninitialize();
+}
+
+void GLRenderer::Render(double time, const Scene* scene, const glm::mat4& projMatrix)
+{
+    static const GLfloat gray[] = { 0.3f, 0.3f, 0.3f, 1.0f };
+    static const GLfloat one = 1.0f;
+
+    UpdateShaderReload();
+    m_textureUploadQueue.Update();
+    m_materialTextures.BuildMipmaps();
+    if (m_useTextureStreaming)
+    {
+        m_textureStreamer.Update();
+    }
+
+    // State could be changed outside of the frame, e.g. by mesh generation.
+    m_stateCache.BeginFrame();
+    m_stateCache.Invalidate();
+    m_gpuTimer.BeginFrame();
+
+    glEnable(GL_DEPTH_TEST);
+
+    m_uniformRing.BeginFrame(GetUniformFrameSize());
+    UpdateFrameConstants(scene, projMatrix);
+    UpdateLightsBlock(scene, projMatrix);
+
+    // Scene goes to a pooled target only if there are effects to apply.
+    RenderTarget* pSceneTarget = nullptr;
+    if (!m_postprocessPasses.empty())
+    {
+        pSceneTarget = AcquireRenderTarget({ m_viewportWidth, m_viewportHeight, GL_RGBA8, true });
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, pSceneTarget ? pSceneTarget->framebuffer : 0);
+
+    glClearColor(gray[0], gray[1], gray[2], gray[3]);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    // First pass
+    RenderScene(scene);
+
+    if (pSceneTarget)
+    {
+        ApplyPostprocessEffects(pSceneTarget);
+    }
+
+    m_uniformRing.EndFrame();
+    m_stateCache.EndFrame();
+    m_gpuTimer.EndFrame();
+}
+
+void GLRenderer::AddPostprocessEffect(const char* szVertexShaderPath, const char* szFragmentShaderPath,
+                                      const glm::mat3& kernel)
+{
+    VSUtils::ShaderProgram* pProgram = new VSUtils::ShaderProgram();
+    pProgram->SetVertexShader(szVertexShaderPath);
+    pProgram->SetFragmentShader(szFragmentShaderPath);
+    if (pProgram->CompileProgram(&m_shaderCache) == 0)
+    {
+        delete pProgram;
+        return;
+    }
+
+    m_stateCache.InvalidateProgram(pProgram->GetProgram());
+
+    pProgram->UseProgram();
+    pProgram->SetInt("screenTexture", 0);
+
+    PostprocessPass pass;
+    pass.type = PostprocessPassType::Kernel;
+    pass.pProgram = pProgram;
+    pass.weights.assign(&kernel[0][0], &kernel[0][0] + 9);
+    pass.weightsLocation = pProgram->GetUniformLocation("kernel");
+
+    m_postprocessPasses.push_back(pass);
+}
+
+void GLRenderer::AddConvolutionEffect(const float* pWeights, size_t kernelSize)
+{
+    if (pWeights == nullptr || kernelSize % 2 == 0)
+    {
+        fprintf(stderr, "Convolution kernel size should be odd, got %zu\n", kernelSize);
+        return;
+    }
+
+    const int radius = static_cast<int>(kernelSize / 2);
+
+    // Separable kernel costs 2 * size taps per pixel instead of size^2.
+    std::vector<float> column;
+    std::vector<float> row;
+    if (radius <= static_cast<int>(maxSeparableKernelRadius) && SeparateKernel(pWeights, kernelSize, column, row))
+    {
+        if (!PrepareConvolutionProgram(m_separableConvolutionShader, PostprocessPassType::Separable))
+            return;
+
+        PostprocessPass pass;
+        pass.type = PostprocessPassType::Separable;
+        pass.pProgram = &m_separableConvolutionShader;
+        pass.radius = radius;
+        pass.weightsLocation = m_separableConvolutionShader.GetUniformLocation("weights");
+        pass.radiusLocation = m_separableConvolutionShader.GetUniformLocation("radius");
+        pass.directionLocation = m_separableConvolutionShader.GetUniformLocation("direction");
+
+        // Direction is in texels, it's scaled to the viewport when the pass is drawn.
+        pass.weights = row;
+        pass.direction = glm::vec2(1.0f, 0.0f);
+        m_postprocessPasses.push_back(pass);
+
+        // Top row of the kernel is the first one, texture rows go bottom up.
+        pass.weights = column;
+        pass.direction = glm::vec2(0.0f, -1.0f);
+        m_postprocessPasses.push_back(pass);
+        return;
+    }
+
+    if (radius > static_cast<int>(maxComputeKernelRadius))
+    {
+        fprintf(stderr, "Non-separable convolution kernel is limited to %zux%zu, got %zux%zu\n",
+                2 * maxComputeKernelRadius + 1, 2 * maxComputeKernelRadius + 1, kernelSize, kernelSize);
+        return;
+    }
+
+    if (!PrepareConvolutionProgram(m_convolutionComputeShader, PostprocessPassType::Compute))
+        return;
+
+    PostprocessPass pass;
+    pass.type = PostprocessPassType::Compute;
+    glGenBuffers(1, &pass.weightsBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pass.weightsBuffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(kernelSize * kernelSize * sizeof(float)), pWeights, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    pass.pProgram = &m_convolutionComputeShader;
+    pass.radius = radius;
+    pass.radiusLocation = m_convolutionComputeShader.GetUniformLocation("radius");
+
+    m_postprocessPasses.push_back(pass);
+}
+
+void GLRenderer::ClearPostprocessEffects()
+{
+    for (PostprocessPass& pass : m_postprocessPasses)
+    {
+        if (pass.type == PostprocessPassType::Kernel)
+        {
+            m_shaderReloader.Cancel(pass.pProgram);
+            delete pass.pProgram;
+        }
+
+        if (pass.weightsBuffer)
+        {
+            glDeleteBuffers(1, &pass.weightsBuffer);
+        }
+    }
+
+    m_postprocessPasses.clear();
+    m_renderTargetPool.Trim();
+}
+
+bool GLRenderer::PrepareConvolutionProgram(VSUtils::ShaderProgram& program, PostprocessPassType type)
+{
+    if (program.GetProgram() != 0)
+        return true;
+
+    if (type == PostprocessPassType::Compute)
+    {
+        program.SetComputeShader("Postprocess/Convolution.cs.glsl");
+    }
+    else
+    {
+        program.SetVertexShader("Postprocess/KernelPostprocess.vs.glsl");
+        program.SetFragmentShader("Postprocess/SeparableConvolution.fs.glsl");
+    }
+
+    if (program.CompileProgram(&m_shaderCache) == 0)
+        return false;
+
+    m_stateCache.InvalidateProgram(program.GetProgram());
+
+    if (type == PostprocessPassType::Separable)
+    {
+        program.UseProgram();
+        program.SetInt("screenTexture", 0);
+    }
+
+    return true;
+}
+
+void GLRenderer::UpdateShaderReload()
+{
+    if (!m_shaderWatcher.IsEnabled())
+        return;
+
+    m_changedShaderFiles.clear();
+    m_shaderWatcher.Poll(m_changedShaderFiles);
+
+    if (!m_changedShaderFiles.empty())
+    {
+        // Editors write a file in several steps, each one is reported.
+        std::sort(m_changedShaderFiles.begin(), m_changedShaderFiles.end());
+        m_changedShaderFiles.erase(std::unique(m_changedShaderFiles.begin(), m_changedShaderFiles.end()),
+                                   m_changedShaderFiles.end());
+
+        for (const std::string& file : m_changedShaderFiles)
+        {
+            printf("Shader %s changed, reloading\n", file.c_str());
+        }
+
+        m_mainVariants.RetryFailedVariants();
+        m_depthPrepassVariants.RetryFailedVariants();
+
+        auto reloadIfChanged = [this](VSUtils::ShaderProgram& program)
+        {
+            ReloadIfChanged(program);
+        };
+        m_mainVariants.ForEachVariant(reloadIfChanged);
+        m_depthPrepassVariants.ForEachVariant(reloadIfChanged);
+
+        ReloadIfChanged(m_placeholderShader);
+        ReloadIfChanged(m_depthPlaceholderShader);
+        ReloadIfChanged(lightShader);
+        ReloadIfChanged(m_separableConvolutionShader);
+        ReloadIfChanged(m_convolutionComputeShader);
+
+        for (PostprocessPass& pass : m_postprocessPasses)
+        {
+            if (pass.type == PostprocessPassType::Kernel)
+            {
+                ReloadIfChanged(*pass.pProgram);
+            }
+        }
+    }
+
+    m_reloadedPrograms.clear();
+    m_shaderReloader.Update(m_reloadedPrograms);
+
+    for (VSUtils::ShaderProgram* pProgram : m_reloadedPrograms)
+    {
+        OnProgramReloaded(*pProgram);
+    }
+}
+
+void GLRenderer::ReloadIfChanged(VSUtils::ShaderProgram& program)
+{
+    // Programs which aren't compiled yet will read the new sources anyway.
+    if (program.GetProgram() == 0)
+        return;
+
+    for (const std::string& file : m_changedShaderFiles)
+    {
+        if (program.DependsOn(file))
+        {
+            m_shaderReloader.Reload(&program);
+            return;
+        }
+    }
+}
+
+void GLRenderer::OnProgramReloaded(VSUtils::ShaderProgram& program)
+{
+    // Name of the new program could belong to a deleted one before.
+    m_stateCache.InvalidateProgram(program.GetProgram());
+
+    bool isMainVariant = false;
+    m_mainVariants.ForEachVariant([&](const VSUtils::ShaderProgram& variant)
+    {
+        isMainVariant = isMainVariant || &variant == &program;
+    });
+
+    if (isMainVariant)
+    {
+        ApplyShaderUniforms(program);
+    }
+
+    bool hasScreenTexture = &program == &m_separableConvolutionShader;
+    for (PostprocessPass& pass : m_postprocessPasses)
+    {
+        if (pass.pProgram != &program)
+            continue;
+
+        const bool isKernel = pass.type == PostprocessPassType::Kernel;
+        hasScreenTexture = hasScreenTexture || isKernel;
+
+        pass.weightsLocation = program.GetUniformLocation(isKernel ? "kernel" : "weights");
+        if (!isKernel)
+        {
+            pass.radiusLocation = program.GetUniformLocation("radius");
+        }
+        if (pass.type == PostprocessPassType::Separable)
+        {
+            pass.directionLocation = program.GetUniformLocation("direction");
+        }
+    }
+
+    // Bound behind the state cache, which is invalidated at the beginning of the frame.
+    if (hasScreenTexture)
+    {
+        program.UseProgram();
+        program.SetInt("screenTexture", 0);
+    }
+}
+
+RenderTarget* GLRenderer::AcquireRenderTarget(const RenderTargetDesc& desc)
+{
+    const size_t targetsCount = m_renderTargetPool.GetTargetsCount();
+    RenderTarget* pTarget = m_renderTargetPool.Acquire(desc);
+
+    if (m_renderTargetPool.GetTargetsCount() != targetsCount)
+    {
+        m_stateCache.Invalidate();
+    }
+
+    return pTarget;
+}
+
+void GLRenderer::ApplyPostprocessEffects(RenderTarget* pSourceTarget)
+{
+    System::ScopedCpuTimer cpuTimer(m_pProfiler, "Postprocess");
+    ScopedGPUTimer gpuTimer(m_gpuTimer, "Postprocess");
+
+    glDisable(GL_DEPTH_TEST);
+
+    // Intermediate targets ping-pong: the source of a pass is released right after it,
+    // so the pass after the next one renders into it again.
+    const RenderTargetDesc intermediateDesc{ m_viewportWidth, m_viewportHeight, GL_RGBA8, false };
+
+    const glm::vec2 texelSize(1.0f / std::max<float>(m_viewportWidth, 1.0f),
+                              1.0f / std::max<float>(m_viewportHeight, 1.0f));
+
+    const size_t passesCount = m_postprocessPasses.size();
+    for (size_t i = 0; i < passesCount && pSourceTarget; ++i)
+    {
+        const PostprocessPass& pass = m_postprocessPasses[i];
+        const bool isLast = i + 1 == passesCount;
+
+        if (pass.type == PostprocessPassType::Compute)
+        {
+            // Images can't be bound from the default framebuffer, the last pass is blitted to it.
+            RenderTarget* pTarget = AcquireRenderTarget(intermediateDesc);
+            if (pTarget == nullptr)
+                break;
+
+            DispatchConvolution(pass, pSourceTarget, pTarget);
+            m_renderTargetPool.Release(pSourceTarget);
+            pSourceTarget = pTarget;
+
+            if (isLast)
+            {
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, pTarget->framebuffer);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                glBlitFramebuffer(0, 0, m_viewportWidth, m_viewportHeight, 0, 0, m_viewportWidth, m_viewportHeight,
+                                  GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            }
+            continue;
+        }
+
+        // Last pass and the one which didn't get a target draw to the screen.
+        RenderTarget* pTarget = !isLast ? AcquireRenderTarget(intermediateDesc) : nullptr;
+        glBindFramebuffer(GL_FRAMEBUFFER, pTarget ? pTarget->framebuffer : 0);
+
+        m_stateCache.UseProgram(*pass.pProgram);
+        m_stateCache.SetFloatN(*pass.pProgram, pass.weightsLocation, pass.weights.data(), pass.weights.size());
+        if (pass.type == PostprocessPassType::Separable)
+        {
+            m_stateCache.SetInt(*pass.pProgram, pass.radiusLocation, pass.radius);
+            m_stateCache.SetVec2(*pass.pProgram, pass.directionLocation, pass.direction * texelSize);
+        }
+
+        m_stateCache.BindVertexArray(m_screenQuadVAO);
+        m_stateCache.BindTexture(0, GL_TEXTURE_2D, pSourceTarget->colorTexture);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        m_renderTargetPool.Release(pSourceTarget);
+        pSourceTarget = pTarget;
+    }
+
+    m_renderTargetPool.Release(pSourceTarget);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GLRenderer::DispatchConvolution(const PostprocessPass& pass, const RenderTarget* pSourceTarget,
+                                     const RenderTarget* pTarget)
+{
+    m_stateCache.UseProgram(*pass.pProgram);
+    m_stateCache.SetInt(*pass.pProgram, pass.radiusLocation, pass.radius);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, convolutionWeightsBinding, pass.weightsBuffer);
+    m_stateCache.BindTexture(0, GL_TEXTURE_2D, pSourceTarget->colorTexture);
+    glBindImageTexture(0, pTarget->colorTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, pTarget->desc.colorFormat);
+
+    const GLuint groupsX = (m_viewportWidth + convolutionTileSize - 1) / convolutionTileSize;
+    const GLuint groupsY = (m_viewportHeight + convolutionTileSize - 1) / convolutionTileSize;
+    glDispatchCompute(groupsX, groupsY, 1);
+
+    // Result is sampled by the next pass or blitted to the screen.
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+}
+
+size_t GLRenderer::GenerateMeshRenderData(const Mesh& mesh)
+{
+    if (mesh.GetMeshRenderDataId())
+        return mesh.GetMeshRenderDataId();
+
+    m_renderObjectsMap.try_emplace(++m_renderDataIDCounter, new RenderData());
+
+    RenderData* meshRenderData = m_renderObjectsMap[m_renderDataIDCounter];
+
+    if (m_useMultiDrawIndirect)
+    {
+        const GeometryAllocation allocation = m_geometryPool.Allocate(mesh);
+        meshRenderData->isPooled = true;
+        meshRenderData->baseVertex = allocation.baseVertex;
+        meshRenderData->firstIndex = allocation.firstIndex;
+        meshRenderData->verticesCount = allocation.verticesCount;
+        meshRenderData->indicesCount = allocation.indicesCount;
+
+        return m_renderDataIDCounter;
+    }
+
+    glGenVertexArrays(1, &meshRenderData->vao);
+    glGenBuffers(1, &meshRenderData->vbo);
+    glGenBuffers(1, &meshRenderData->ebo);
+
+    glBindVertexArray(meshRenderData->vao);
+
+    constexpr static GLsizei sizeofVertex = sizeof(Vertex);
+
+    const std::vector<Vertex>& vertices = mesh.GetVertices();
+    glBindBuffer(GL_ARRAY_BUFFER, meshRenderData->vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeofVertex * vertices.size(),
+                 vertices.data(), GL_STATIC_DRAW);
+
+    constexpr static GLsizei sizeofTriple = sizeof(VSUtils::Face);
+
+    const std::vector<VSUtils::Face>& faces = mesh.GetFaces();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshRenderData->ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeofTriple * faces.size(),
+                 faces.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE,
+                          sizeofVertex, nullptr);
+
+    constexpr static size_t normalOffset = offsetof(Vertex, normal);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE,
+                          sizeofVertex, (void*)(normalOffset));
+
+    if (mesh.HasTextureCoordinates())
+    {
+        constexpr static size_t textureOffset = offsetof(Vertex, textureCoord);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE,
+                              sizeofVertex, (void*)(textureOffset));
+    }
+
+    InstanceBuffer::SetupVertexAttributes();
+
+    glBindVertexArray(0);
+
+    return m_renderDataIDCounter;
+}
+
+void GLRenderer::RemoveMeshRenderData(size_t renderDataId)
+{
+    auto renderDataIter = m_renderObjectsMap.find(renderDataId);
+    if (renderDataIter == m_renderObjectsMap.end())
+        return;
+
+    RenderData* pRenderData = renderDataIter->second;
+    if (pRenderData->isPooled)
+    {
+        GeometryAllocation allocation;
+        allocation.baseVertex = pRenderData->baseVertex;
+        allocation.firstIndex = pRenderData->firstIndex;
+        allocation.verticesCount = pRenderData->verticesCount;
+        allocation.indicesCount = pRenderData->indicesCount;
+        m_geometryPool.Free(allocation);
+    }
+
+    delete pRenderData;
+    m_renderObjectsMap.erase(renderDataIter);
+}
+
+void GLRenderer::Reset()
+{
+    ClearStoredObjects();
+}
+
+void GLRenderer::ClearStoredObjects()
+{
+    for (auto& storedPair : m_renderObjectsMap)
+    {
+        delete storedPair.second;
+    }
+
+    m_renderObjectsMap.clear();
+
+    m_geometryPool.Reset();
+}
+
+unsigned int GLRenderer::GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount)
+{
+    return static_cast<unsigned int>(m_materialTextures.AddTexture(data, width, height, channelsCount));
+}
+
+unsigned int GLRenderer::GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture)
+{
+    return static_cast<unsigned int>(m_materialTextures.AddCompressedTexture(texture));
+}
+
+unsigned int GLRenderer::GetStreamedTextureRenderInfo(const char* szCookedPath)
+{
+    if (!m_useTextureStreaming)
+        return 0;
+
+    return static_cast<unsigned int>(m_textureStreamer.AddTexture(szCookedPath));
+}
+
+unsigned int GLRenderer::GetQueuedTextureRenderInfo(int width, int height, int channelsCount, TextureDecoder decoder)
+{
+    return static_cast<unsigned int>(m_textureUploadQueue.QueueTexture(width, height, channelsCount, std::move(decoder)));
+}
+
+void GLRenderer::SetTextureStreaming(bool enable, size_t budget)
+{
+    // In texture arrays every streamed size takes a layer of another array and the dropped layers aren't
+    // given back, so the arrays would outgrow the budget and run out.
+    if (enable && !m_materialTextures.IsBindless())
+    {
+        fprintf(stderr, "Texture streaming needs bindless textures, cooked textures are loaded whole\n");
+        enable = false;
+    }
+
+    m_useTextureStreaming = enable;
+    m_textureStreamer.SetBudget(budget);
+}
+
+void GLRenderer::DeleteTextureRenderInfo(unsigned int textureId)
+{
+    m_textureStreamer.RemoveTexture(static_cast<GLuint>(textureId));
+    m_textureUploadQueue.CancelTexture(static_cast<GLuint>(textureId));
+    m_materialTextures.RemoveTexture(static_cast<GLuint>(textureId));
+}
+
+void GLRenderer::Initialize()
+{
+    glewInit();
+    glDebugMessageCallback((GLDEBUGPROC)DebugCallback, this);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    // Textures are loaded before RenderStart.
+    m_materialTextures.Initialize();
+    m_textureStreamer.Initialize(&m_materialTextures, GetEngine().GetJobSystem());
+    m_textureUploadQueue.Initialize(&m_materialTextures, GetEngine().GetJobSystem());
+}
+
+void GLRenderer::RenderScene(const Scene* scene)
+{
+    System::ScopedCpuTimer cpuTimer(m_pProfiler, "RenderScene");
+    ScopedGPUTimer gpuTimer(m_gpuTimer, "RenderScene");
+
+    if (!BuildInstanceBatches(scene->GetSceneObjects()))
+        return;
+
+    if (m_useTextureStreaming)
+    {
+        RequestTextureLevels(scene);
+    }
+
+    m_directBatches.clear();
+    m_pooledBatches.clear();
+    m_transparentBatches.clear();
+    for (size_t batchIndex = 0; batchIndex < m_instanceBatches.size(); ++batchIndex)
+    {
+        const InstanceBatch& batch = m_instanceBatches[batchIndex];
+        if (batch.isTransparent)
+        {
+            m_transparentBatches.push_back(batchIndex);
+        }
+        else if (batch.pRenderData->isPooled)
+        {
+            m_pooledBatches.push_back(batchIndex);
+        }
+        else
+        {
+            m_directBatches.push_back(batchIndex);
+        }
+    }
+
+    // Materials, lights and indirect commands of the frame. Every storage block may need alignment
+    // padding and at least minStorageBlockSize bytes.
+    const size_t storageFrameSize = m_materialBlocks.size() * sizeof(MaterialBlock) +
+                                    m_pointLights.size() * sizeof(PointLightBlock) +
+                                    m_lightClusters.GetClusters().size() * sizeof(LightClusterBlock) +
+                                    m_lightClusters.GetLightIndices().size() * sizeof(uint32_t) +
+                                    4 * (m_storageAlignment + minStorageBlockSize) +
+                                    m_pooledBatches.size() * sizeof(DrawElementsIndirectCommand) + sizeof(GLuint);
+    m_storageRing.BeginFrame(storageFrameSize);
+
+    UploadMaterials();
+    UploadLights();
+    m_materialTextures.Bind(m_stateCache);
+
+    PrepareMaterialPrograms();
+    RecordDirectBatches();
+    PreparePooledBatches();
+
+    m_transparentCommands.Reset();
+    RecordBatches(m_transparentBatches, 0, m_transparentBatches.size(), m_transparentCommands);
+
+    if (m_useDepthPrepass)
+    {
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        DrawOpaqueBatches(m_depthPrepassPrograms);
+
+        // Depth is final, the shading pass only runs for the closest fragments.
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_EQUAL);
+    }
+
+    DrawOpaqueBatches(m_mainPrograms);
+
+    glDepthFunc(GL_LESS);
+
+    // Transparent batches are tested against the opaque depth, but don't occlude each other.
+    if (!m_transparentCommands.IsEmpty())
+    {
+        CommandExecutor executor{ m_stateCache, m_instanceBuffer, m_mainPrograms };
+
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+        m_transparentCommands.Execute(executor);
+        glDisable(GL_BLEND);
+    }
+
+    glDepthMask(GL_TRUE);
+
+    m_stateCache.BindVertexArray(0);
+
+    m_instanceBuffer.EndFrame();
+    m_storageRing.EndFrame();
+}
+
+void GLRenderer::DrawOpaqueBatches(const MaterialPrograms& programs)
+{
+    // Buffers are replayed in the order of the batches they were recorded for.
+    CommandExecutor executor{ m_stateCache, m_instanceBuffer, programs };
+    for (const CommandBuffer& commandBuffer : m_commandBuffers)
+    {
+        commandBuffer.Execute(executor);
+    }
+
+    DrawPooledBatches(programs);
+}
+
+void GLRenderer::PrepareMaterialPrograms()
+{
+    uint32_t lightFlags = 0;
+    if (m_lightsBlock.directionalLightsCount > 0)
+    {
+        lightFlags |= DirectionalLightFlag;
+    }
+    if (m_lightsBlock.pointLightsCount > 0)
+    {
+        lightFlags |= PointLightsFlag;
+    }
+    if (m_lightsBlock.flashlightsCount > 0)
+    {
+        lightFlags |= FlashlightFlag;
+    }
+
+    std::array<bool, materialVariantsCount> isVariantUsed = {};
+    for (uint32_t variant : m_materialVariants)
+    {
+        isVariantUsed[variant] = true;
+    }
+
+    for (uint32_t variant = 0; variant < materialVariantsCount; ++variant)
+    {
+        m_mainPrograms[variant] = nullptr;
+        m_depthPrepassPrograms[variant] = nullptr;
+        if (!isVariantUsed[variant])
+            continue;
+
+        // Variants which aren't compiled yet are replaced by the placeholders, so nothing waits for them.
+        VSUtils::ShaderProgram* pProgram = GetProgramVariant(m_mainVariants, variant | lightFlags);
+        m_mainPrograms[variant] = pProgram ? pProgram : GetPlaceholder(m_placeholderShader);
+
+        if (m_useDepthPrepass)
+        {
+            // Only the alpha test depends on the material.
+            pProgram = GetProgramVariant(m_depthPrepassVariants, variant & HasDiffuseMapFlag);
+            m_depthPrepassPrograms[variant] = pProgram ? pProgram : GetPlaceholder(m_depthPlaceholderShader);
+
+            // Depth placeholder has no alpha test. Shading pass mustn't discard either, otherwise the cut-out
+            // texels fail GL_EQUAL against the placeholder depth and show as holes.
+            if (pProgram == nullptr && (variant & HasDiffuseMapFlag))
+            {
+                m_mainPrograms[variant] = GetPlaceholder(m_placeholderShader);
+            }
+        }
+    }
+}
+
+VSUtils::ShaderProgram* GLRenderer::GetProgramVariant(VSUtils::ShaderVariants& variants, uint32_t key)
+{
+    const size_t compiledCount = variants.GetCompiledCount();
+    VSUtils::ShaderProgram* pProgram = variants.GetVariant(key);
+
+    // Name of a new program could belong to a deleted one before.
+    if (pProgram && variants.GetCompiledCount() != compiledCount)
+    {
+        m_stateCache.InvalidateProgram(pProgram->GetProgram());
+
+        if (&variants == &m_mainVariants)
+        {
+            ApplyShaderUniforms(*pProgram);
+        }
+    }
+
+    return pProgram;
+}
+
+void GLRenderer::RecordDirectBatches()
+{
+    System::JobSystem* pJobSystem = GetEngine().GetJobSystem();
+
+    // One buffer per thread which can take part in recording.
+    const size_t buffersCount = pJobSystem ? pJobSystem->GetWorkerCount() + 1 : 1;
+    if (m_commandBuffers.size() < buffersCount)
+    {
+        m_commandBuffers.resize(buffersCount);
+    }
+
+    for (CommandBuffer& commandBuffer : m_commandBuffers)
+    {
+        commandBuffer.Reset();
+    }
+
+    // Uniform blocks could be rebound by other passes.
+    const GLuint uniformBuffer = m_uniformRing.GetBuffer();
+    m_commandBuffers[0].Record(BindUniformBlockCommand{ frameConstantsBinding, uniformBuffer,
+                                                        static_cast<uint32_t>(m_frameConstantsOffset),
+                                                        static_cast<uint32_t>(sizeof(FrameConstantsBlock)) });
+    m_commandBuffers[0].Record(BindUniformBlockCommand{ lightsBinding, uniformBuffer,
+                                                        static_cast<uint32_t>(m_lightsOffset),
+                                                        static_cast<uint32_t>(sizeof(LightsBlock)) });
+
+    const size_t batchesCount = m_directBatches.size();
+    if (batchesCount == 0)
+        return;
+
+    // Small frames aren't worth spreading over the threads.
+    constexpr size_t minBatchesPerBuffer = 64;
+    const size_t batchesPerBuffer = std::max((batchesCount + buffersCount - 1) / buffersCount, minBatchesPerBuffer);
+
+    auto recordBatches = [this, batchesPerBuffer](size_t begin, size_t end)
+    {
+        RecordBatches(m_directBatches, begin, end, m_commandBuffers[begin / batchesPerBuffer]);
+    };
+
+    if (pJobSystem == nullptr)
+    {
+        recordBatches(0, batchesCount);
+    }
+    else
+    {
+        pJobSystem->ParallelFor(batchesCount, batchesPerBuffer, recordBatches);
+    }
+}
+
+void GLRenderer::RecordBatches(const std::vector<size_t>& batches, size_t begin, size_t end,
+                               CommandBuffer& commandBuffer) const
+{
+    // Buffers are replayed after each other, so every range selects its first variant.
+    uint32_t currentVariant = materialVariantsCount;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const InstanceBatch& batch = m_instanceBatches[batches[i]];
+        const RenderData* pRenderData = batch.pRenderData;
+
+        // Pooled meshes get here when they are transparent: order matters more than the draw calls count.
+        const GLuint vertexArray = pRenderData->isPooled ? m_geometryPool.GetVAO() : pRenderData->vao;
+        commandBuffer.Record(BindVertexArrayCommand{ vertexArray });
+        commandBuffer.Record(BindInstancesCommand{ static_cast<uint32_t>(batch.firstInstance) });
+
+        // Textures come from the material block, only the variant changes between materials.
+        const uint32_t variant = m_materialVariants[batch.materialIndex];
+        if (variant != currentVariant)
+        {
+            commandBuffer.Record(UseMaterialVariantCommand{ variant });
+            currentVariant = variant;
+        }
+
+        commandBuffer.Record(DrawInstancedCommand{ static_cast<uint32_t>(batch.pMesh->FacesCount() * 3),
+                                                   static_cast<uint32_t>(batch.instancesCount),
+                                                   pRenderData->isPooled ? pRenderData->firstIndex : 0u,
+                                                   pRenderData->isPooled ? pRenderData->baseVertex : 0 });
+    }
+}
+
+void GLRenderer::PreparePooledBatches()
+{
+    if (m_pooledBatches.empty())
+        return;
+
+    auto getVariant = [this](size_t batchIndex)
+    {
+        return m_materialVariants[m_instanceBatches[batchIndex].materialIndex];
+    };
+
+    // Batches drawn by the same program become a single indirect draw call.
+    std::stable_sort(m_pooledBatches.begin(), m_pooledBatches.end(), [&getVariant](size_t lhs, size_t rhs)
+    {
+        return getVariant(lhs) < getVariant(rhs);
+    });
+
+    const size_t commandsCount = m_pooledBatches.size();
+
+    DrawElementsIndirectCommand* pCommands = static_cast<DrawElementsIndirectCommand*>(
+        m_storageRing.Allocate(commandsCount * sizeof(DrawElementsIndirectCommand), sizeof(GLuint),
+                               m_pooledCommandsOffset));
+    if (pCommands == nullptr)
+    {
+        m_pooledBatches.clear();
+        return;
+    }
+
+    for (size_t i = 0; i < commandsCount; ++i)
+    {
+        const InstanceBatch& batch = m_instanceBatches[m_pooledBatches[i]];
+        const RenderData* renderData = batch.pRenderData;
+
+        DrawElementsIndirectCommand& command = pCommands[i];
+        command.count = static_cast<GLuint>(batch.pMesh->FacesCount() * 3);
+        command.instanceCount = static_cast<GLuint>(batch.instancesCount);
+        command.firstIndex = renderData->firstIndex;
+        command.baseVertex = renderData->baseVertex;
+        command.baseInstance = static_cast<GLuint>(batch.firstInstance);
+    }
+}
+
+void GLRenderer::DrawPooledBatches(const MaterialPrograms& programs)
+{
+    if (m_pooledBatches.empty())
+        return;
+
+    auto getVariant = [this](size_t batchIndex)
+    {
+        return m_materialVariants[m_instanceBatches[batchIndex].materialIndex];
+    };
+
+    const size_t commandsCount = m_pooledBatches.size();
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_storageRing.GetBuffer());
+
+    m_stateCache.BindVertexArray(m_geometryPool.GetVAO());
+    m_instanceBuffer.Bind(0);
+
+    size_t rangeBegin = 0;
+    while (rangeBegin < commandsCount)
+    {
+        const uint32_t variant = getVariant(m_pooledBatches[rangeBegin]);
+
+        size_t rangeEnd = rangeBegin + 1;
+        while (rangeEnd < commandsCount && getVariant(m_pooledBatches[rangeEnd]) == variant)
+        {
+            ++rangeEnd;
+        }
+
+        VSUtils::ShaderProgram* pProgram = programs[variant];
+        if (pProgram == nullptr)
+        {
+            rangeBegin = rangeEnd;
+            continue;
+        }
+
+        m_stateCache.UseProgram(*pProgram);
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                                    reinterpret_cast<const void*>(m_pooledCommandsOffset +
+                                                                  rangeBegin * sizeof(DrawElementsIndirectCommand)),
+                                    static_cast<GLsizei>(rangeEnd - rangeBegin), 0);
+
+        rangeBegin = rangeEnd;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+bool GLRenderer::BuildInstanceBatches(const std::vector<SceneObject*>& objects)
+{
+    m_instanceBatches.clear();
+    m_batchIndices.clear();
+
+    m_materialIndices.clear();
+    m_materialBlocks.clear();
+    m_materialVariants.clear();
+
+    const size_t objectsCount = objects.size();
+    if (objectsCount == 0)
+        return false;
+
+    // Marks transparent objects until their batches are created.
+    constexpr size_t transparentBatchIndex = SIZE_MAX;
+
+    // Batches keep the order of their first objects, so front to back sorting is mostly preserved.
+    m_objectBatchIndices.resize(objectsCount);
+    for (size_t i = 0; i < objectsCount; ++i)
+    {
+        const Mesh& mesh = objects[i]->GetMesh();
+        const Material* pMaterial = mesh.GetMaterial();
+        if (pMaterial && pMaterial->IsTransparent())
+        {
+            m_objectBatchIndices[i] = transparentBatchIndex;
+            continue;
+        }
+
+        const InstanceBatchKey key{ mesh.GetMeshRenderDataId(), pMaterial };
+
+        auto insertResult = m_batchIndices.try_emplace(key, m_instanceBatches.size());
+        if (insertResult.second)
+        {
+            const RenderData* pRenderData = m_renderObjectsMap[mesh.GetMeshRenderDataId()];
+            m_instanceBatches.push_back({ &mesh, pRenderData, GetMaterialIndex(pMaterial), 0, 0 });
+        }
+
+        const size_t batchIndex = insertResult.first->second;
+        m_objectBatchIndices[i] = batchIndex;
+        ++m_instanceBatches[batchIndex].instancesCount;
+    }
+
+    // Objects are sorted front to back, transparent ones are taken in reverse.
+    for (size_t i = objectsCount; i-- > 0;)
+    {
+        if (m_objectBatchIndices[i] != transparentBatchIndex)
+            continue;
+
+        const Mesh& mesh = objects[i]->GetMesh();
+        const RenderData* pRenderData = m_renderObjectsMap[mesh.GetMeshRenderDataId()];
+
+        m_objectBatchIndices[i] = m_instanceBatches.size();
+        m_instanceBatches.push_back({ &mesh, pRenderData, GetMaterialIndex(mesh.GetMaterial()), 0, 1, true });
+    }
+
+    size_t firstInstance = 0;
+    for (InstanceBatch& batch : m_instanceBatches)
+    {
+        batch.firstInstance = firstInstance;
+        firstInstance += batch.instancesCount;
+        // Used as a write cursor below, restored to the count by the time all instances are written.
+        batch.instancesCount = 0;
+    }
+
+    InstanceData* pInstances = m_instanceBuffer.BeginFrame(objectsCount);
+    if (pInstances == nullptr)
+        return false;
+
+    for (size_t i = 0; i < objectsCount; ++i)
+    {
+        InstanceBatch& batch = m_instanceBatches[m_objectBatchIndices[i]];
+
+        InstanceData& instance = pInstances[batch.firstInstance + batch.instancesCount++];
+        instance.modelMatrix = objects[i]->GetTransformation();
+        instance.color = glm::vec4(objects[i]->GetObjectColor(), 1.0f);
+        instance.materialIndex = static_cast<unsigned int>(batch.materialIndex);
+    }
+
+    return true;
+}
+
+size_t GLRenderer::GetMaterialIndex(const Material* pMaterial)
+{
+    auto insertResult = m_materialIndices.try_emplace(pMaterial, m_materialBlocks.size());
+    if (!insertResult.second)
+        return insertResult.first->second;
+
+    MaterialBlock& block = m_materialBlocks.emplace_back();
+    uint32_t& variant = m_materialVariants.emplace_back(0);
+
+    if (pMaterial)
+    {
+        block.ambient = pMaterial->GetAmbient();
+        block.diffuse = pMaterial->GetDiffuse();
+        block.specular = pMaterial->GetSpecular();
+        block.shininess = pMaterial->GetShininess();
+        block.opacity = pMaterial->GetOpacity();
+
+        // The shader samples the first map of each type, the following ones are ignored.
+        const size_t textureCount = pMaterial->GetTextureCount();
+        for (size_t i = 0; i < textureCount; ++i)
+        {
+            const Texture& texture = *pMaterial->GetTextureAt(i);
+            if (texture.type == TextureType::Diffuse && !(variant & HasDiffuseMapFlag))
+            {
+                if (m_materialTextures.GetReference(texture.id, block.diffuseMap))
+                {
+                    variant |= HasDiffuseMapFlag;
+                }
+            }
+            else if (texture.type == TextureType::Specular && !(variant & HasSpecularMapFlag))
+            {
+                if (m_materialTextures.GetReference(texture.id, block.specularMap))
+                {
+                    variant |= HasSpecularMapFlag;
+                }
+            }
+        }
+    }
+
+    return insertResult.first->second;
+}
+
+void GLRenderer::RequestTextureLevels(const Scene* pScene)
+{
+    const std::vector<SceneObject*>& objects = pScene->GetSceneObjects();
+    const std::vector<float>& screenSizes = pScene->GetSceneObjectScreenSizes();
+
+    const size_t objectsCount = std::min(objects.size(), screenSizes.size());
+    for (size_t i = 0; i < objectsCount; ++i)
+    {
+        const Material* pMaterial = objects[i]->GetMesh().GetMaterial();
+        if (pMaterial == nullptr)
+            continue;
+
+        const float screenSize = screenSizes[i] * m_viewportHeight;
+        const size_t textureCount = pMaterial->GetTextureCount();
+        for (size_t textureIndex = 0; textureIndex < textureCount; ++textureIndex)
+        {
+            m_textureStreamer.RequestLevels(pMaterial->GetTextureAt(textureIndex)->id, screenSize);
+        }
+    }
+}
+
+void GLRenderer::UploadMaterials()
+{
+    UploadStorageBlock(materialsBinding, m_materialBlocks.data(), m_materialBlocks.size() * sizeof(MaterialBlock));
+}
+
+void GLRenderer::UploadLights()
+{
+    const std::vector<LightClusterBlock>& clusters = m_lightClusters.GetClusters();
+    const std::vector<uint32_t>& lightIndices = m_lightClusters.GetLightIndices();
+
+    UploadStorageBlock(pointLightsBinding, m_pointLights.data(), m_pointLights.size() * sizeof(PointLightBlock));
+    UploadStorageBlock(lightClustersBinding, clusters.data(), clusters.size() * sizeof(LightClusterBlock));
+    UploadStorageBlock(clusterLightIndicesBinding, lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+}
+
+void GLRenderer::UploadStorageBlock(GLuint binding, const void* pData, size_t size)
+{
+    // Empty range can't be bound. Shaders don't read it anyway.
+    const size_t bindSize = std::max(size, minStorageBlockSize);
+
+    GLintptr offset = 0;
+    void* pBlockData = m_storageRing.Allocate(bindSize, m_storageAlignment, offset);
+    if (pBlockData == nullptr)
+        return;
+
+    if (size > 0)
+    {
+        std::memcpy(pBlockData, pData, size);
+    }
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, m_storageRing.GetBuffer(), offset, bindSize);
+}
+
+void GLRenderer::UpdateFrameConstants(const Scene* pScene, const glm::mat4& projMatrix)
+{
+    const Camera& camera = pScene->GetRenderCamera();
+
+    m_frameConstants.viewMatrix = camera.GetViewMatrix();
+    m_frameConstants.projMatrix = projMatrix;
+    m_frameConstants.cameraPosition = glm::vec4(camera.GetViewPosition(), 1.0f);
+
+    void* pData = m_uniformRing.Allocate(sizeof(FrameConstantsBlock), m_uniformAlignment, m_frameConstantsOffset);
+    if (pData)
+    {
+        std::memcpy(pData, &m_frameConstants, sizeof(FrameConstantsBlock));
+    }
+}
+
+void GLRenderer::UpdateLightsBlock(const Scene* pScene, const glm::mat4& projMatrix)
+{
+    const std::vector<Light>& lights = pScene->GetLights();
+    const Camera& camera = pScene->GetRenderCamera();
+    const glm::mat4& viewMatrix = camera.GetViewMatrix();
+
+    m_lightsBlock.directionalLightsCount = 0;
+    m_lightsBlock.flashlightsCount = 0;
+    m_lightsBlock.pointLightsCount = 0;
+
+    m_pointLights.clear();
+    for (const Light& light : lights)
+    {
+        const Attenuation& attenuationParams = light.GetAttenuationParamenters();
+        const glm::vec3& lightColor = light.GetColor();
+
+        switch (light.GetLightType())
+        {
+        case LightType::Directional:
+        {
+            DirectionalLightBlock& block = m_lightsBlock.directionalLight;
+            block.direction = viewMatrix * glm::vec4(light.GetDirection(), 0.0f);
+            block.ambient = lightColor * light.GetAmbient();
+            block.diffuse = lightColor * light.GetDiffuse();
+            block.specular = lightColor * light.GetSpecular();
+
+            m_lightsBlock.directionalLightsCount = 1;
+            break;
+        }
+        case LightType::Point:
+        {
+            PointLightBlock& block = m_pointLights.emplace_back();
+            block.position = viewMatrix * glm::vec4(light.GetPosition(), 1.0f);
+            block.ambient = lightColor * light.GetAmbient();
+            block.diffuse = lightColor * light.GetDiffuse();
+            block.specular = lightColor * light.GetSpecular();
+
+            block.constant = attenuationParams.constant;
+            block.linear = attenuationParams.linear;
+            block.quadratic = attenuationParams.quadratic;
+            block.radius = CalculateLightRadius(block);
+            break;
+        }
+        case LightType::Spotlight:
+        {
+            // Flashlight follows the camera.
+            SpotlightBlock& block = m_lightsBlock.flashlight;
+            block.position = viewMatrix * glm::vec4(camera.GetViewPosition(), 1.0f);
+            block.direction = viewMatrix * glm::vec4(-camera.GetViewDirection(), 0.0f);
+            block.ambient = lightColor * light.GetAmbient();
+            block.diffuse = lightColor * light.GetDiffuse();
+            block.specular = lightColor * light.GetSpecular();
+            block.cutOff = light.GetCutOffValue();
+            block.outerCutOff = light.GetOuterCutOffValue();
+
+            block.constant = attenuationParams.constant;
+            block.linear = attenuationParams.linear;
+            block.quadratic = attenuationParams.quadratic;
+
+            m_lightsBlock.flashlightsCount = 1;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    m_lightsBlock.pointLightsCount = static_cast<int>(m_pointLights.size());
+
+    m_lightClusters.Build(projMatrix, m_viewportWidth, m_viewportHeight, m_pointLights, GetEngine().GetJobSystem());
+    m_lightClusters.FillLightsBlock(m_lightsBlock);
+
+    void* pData = m_uniformRing.Allocate(sizeof(LightsBlock), m_uniformAlignment, m_lightsOffset);
+    if (pData)
+    {
+        std::memcpy(pData, &m_lightsBlock, sizeof(LightsBlock));
+    }
+}
+
+void GLRenderer::InitializeBuffers()
+{
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_uniformAlignment = static_cast<size_t>(alignment);
+
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_storageAlignment = static_cast<size_t>(alignment);
+
+    m_uniformRing.Initialize(GetUniformFrameSize());
+
+    constexpr size_t initialStorageFrameSize = 64 * 1024;
+    m_storageRing.Initialize(initialStorageFrameSize);
+
+    constexpr size_t initialInstancesCapacity = 1024;
+    m_instanceBuffer.Initialize(initialInstancesCapacity);
+}
+
+void GLRenderer::UninitializeBuffers()
+{
+    m_uniformRing.Uninitialize();
+    m_storageRing.Uninitialize();
+    m_instanceBuffer.Uninitialize();
+}
+
+size_t GLRenderer::GetUniformFrameSize() const
+{
+    // Every block may need up to alignment bytes of padding in front of it.
+    return sizeof(FrameConstantsBlock) + sizeof(LightsBlock) + 2 * m_uniformAlignment;
+}
+
+void GLRenderer::InitializePostProcessData()
+{
+    // Generate on screen quad vao and vbo
+    float quadVertices[] = {
+        -1.0f,  1.0f,  0.0f, 1.0f,
+        -1.0f, -1.0f,  0.0f, 0.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+
+        -1.0f,  1.0f,  0.0f, 1.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+         1.0f,  1.0f,  1.0f, 1.0f
+    };
+
+    glGenVertexArrays(1, &m_screenQuadVAO);
+    glGenBuffers(1, &m_screenQuadVBO);
+    glBindVertexArray(m_screenQuadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_screenQuadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+}
+
+void GLRenderer::UninitializePostProcessData()
+{
+    glDeleteBuffers(1, &m_screenQuadVBO);
+    glDeleteVertexArrays(1, &m_screenQuadVAO);
+    m_renderTargetPool.Clear();
+}
+
+void GLRenderer::SetShaderUniform(const char* name, bool value)
+{
+    StoreShaderUniform(name, [value](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetBool(location, value);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, int value)
+{
+    StoreShaderUniform(name, [value](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetInt(location, value);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, float value)
+{
+    StoreShaderUniform(name, [value](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetFloat(location, value);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, const glm::vec2& value)
+{
+    StoreShaderUniform(name, [value](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetVec2(location, value);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, float x, float y)
+{
+    StoreShaderUniform(name, [x, y](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetVec2(location, x, y);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, const glm::vec3& value)
+{
+    StoreShaderUniform(name, [value](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetVec3(location, value);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, float x, float y, float z)
+{
+    StoreShaderUniform(name, [x, y, z](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetVec3(location, x, y, z);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, const glm::vec4& value)
+{
+    StoreShaderUniform(name, [value](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetVec4(location, value);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, float x, float y, float z, float w)
+{
+    StoreShaderUniform(name, [x, y, z, w](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetVec4(location, x, y, z, w);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, const glm::mat2& mat)
+{
+    StoreShaderUniform(name, [mat](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetMat2(location, mat);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, const glm::mat3& mat)
+{
+    StoreShaderUniform(name, [mat](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetMat3(location, mat);
+    });
+}
+
+void GLRenderer::SetShaderUniform(const char* name, const glm::mat4& mat)
+{
+    StoreShaderUniform(name, [mat](const VSUtils::ShaderProgram& program, GLint location)
+    {
+        program.SetMat4(location, mat);
+    });
+}
+
+void GLRenderer::StoreShaderUniform(const char* name, UniformSetter setter)
+{
+    m_mainVariants.ForEachVariant([&](const VSUtils::ShaderProgram& program)
+    {
+        setter(program, program.GetUniformLocation(name));
+    });
+
+    m_shaderUniforms[name] = std::move(setter);
+}
+
+void GLRenderer::ApplyShaderUniforms(const VSUtils::ShaderProgram& program) const
+{
+    for (const auto& uniform : m_shaderUniforms)
+    {
+        uniform.second(program, program.GetUniformLocation(uniform.first.c_str()));
+    }
+}
+
+
+}
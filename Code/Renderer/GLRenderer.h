@@ -0,0 +1,376 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CommandBuffer.h"
+#include "GeometryPool.h"
+#include "GLStateCache.h"
+#include "GPUTimer.h"
+#include "InstanceBuffer.h"
+#include "LightClusters.h"
+#include "MaterialTextures.h"
+#include "RenderTargetPool.h"
+#include "Renderer.h"
+#include "RingBuffer.h"
+#include "ShaderCache.h"
+#include "ShaderCompiler.h"
+#include "ShaderProgram.h"
+#include "ShaderReloader.h"
+#include "ShaderVariants.h"
+#include "ShaderWatcher.h"
+#include "TextureStreamer.h"
+#include "TextureUploadQueue.h"
+#include "UniformBlocks.h"
+
+namespace VSEngine {
+namespace System {
+class Profiler;
+}
+
+class Scene;
+class Mesh;
+struct Texture;
+struct RenderData;
+class Material;
+class SceneObject;
+
+enum class TextureType : char;
+
+// Bits of the permutation key of the main program, each enables a define of Main.fs.glsl.
+// Material bits come first: they select the variant of a batch, the light bits are the same for the whole frame.
+enum MainProgramFlags : uint32_t
+{
+    HasDiffuseMapFlag    = 1 << 0,
+    HasSpecularMapFlag   = 1 << 1,
+    DirectionalLightFlag = 1 << 2,
+    PointLightsFlag      = 1 << 3,
+    FlashlightFlag       = 1 << 4
+};
+
+constexpr uint32_t materialVariantsCount = 4;
+
+// Programs of a pass by material variant, nullptr if the variant isn't used or doesn't compile.
+using MaterialPrograms = std::array<VSUtils::ShaderProgram*, materialVariantsCount>;
+
+// Visible objects sharing mesh and material, drawn with a single instanced call.
+struct InstanceBatch
+{
+    const Mesh*       pMesh = nullptr;
+    const RenderData* pRenderData = nullptr;
+    size_t            materialIndex = 0;
+    size_t            firstInstance = 0;
+    size_t            instancesCount = 0;
+    bool              isTransparent = false;
+};
+
+struct InstanceBatchKey
+{
+    size_t          renderDataId = 0;
+    const Material* pMaterial = nullptr;
+
+    bool operator==(const InstanceBatchKey& other) const
+    {
+        return renderDataId == other.renderDataId && pMaterial == other.pMaterial;
+    }
+};
+
+struct InstanceBatchKeyHash
+{
+    size_t operator()(const InstanceBatchKey& key) const
+    {
+        return std::hash<size_t>()(key.renderDataId) ^ (std::hash<const Material*>()(key.pMaterial) << 1);
+    }
+};
+
+enum class PostprocessPassType : char
+{
+    Kernel,       // Custom fragment shader with 3x3 kernel
+    Separable,    // 1D convolution along the direction
+    Compute       // 2D convolution in shared memory tiles
+};
+
+// Full screen pass of the post-process chain.
+struct PostprocessPass
+{
+    PostprocessPassType     type = PostprocessPassType::Kernel;
+    // Kernel passes own their programs, the others use the shared convolution programs.
+    VSUtils::ShaderProgram* pProgram = nullptr;
+    std::vector<float>      weights;
+    // Weights of compute pass, they don't fit into the uniform components guaranteed for compute shaders.
+    GLuint                  weightsBuffer = 0;
+    int                     radius = 0;
+    // Texel step of separable pass.
+    glm::vec2               direction = glm::vec2(0.0f);
+
+    GLint                   weightsLocation = -1;
+    GLint                   radiusLocation = -1;
+    GLint                   directionLocation = -1;
+};
+
+// Layout is defined by glMultiDrawElementsIndirect.
+struct DrawElementsIndirectCommand
+{
+    GLuint count = 0;
+    GLuint instanceCount = 0;
+    GLuint firstIndex = 0;
+    GLint  baseVertex = 0;
+    GLuint baseInstance = 0;
+};
+
+using InstanceBatchIndices = std::unordered_map<InstanceBatchKey, size_t, InstanceBatchKeyHash>;
+using MaterialIndices = std::unordered_map<const Material*, size_t>;
+
+class GLRenderer final : public Renderer
+{
+private:
+    static void APIENTRY DebugCallback(GLenum source,
+                                       GLenum type,
+                                       GLuint id,
+                                       GLenum severity,
+                                       GLsizei length,
+                                       const GLchar* message,
+                                       GLvoid* userParam);
+
+    virtual void OnDebugMessage(GLenum source,
+                                GLenum type,
+                                GLuint id,
+                                GLenum severity,
+                                GLsizei length,
+                                const GLchar* message)
+    {}
+
+public:
+    GLRenderer();
+    GLRenderer(unsigned short viewportWidth, unsigned short viewportHeight);
+    ~GLRenderer() override;
+
+    void         ChangeViewportSize(unsigned short width, unsigned short height) override;
+
+    void         Render(double time, const Scene* scene, const glm::mat4& projMatrix) override;
+    void         RenderStart() override;
+    void         RenderFinish() override;
+
+    void         AddPostprocessEffect(const char* szVertexShaderPath, const char* szFragmentShaderPath,
+                                      const glm::mat3& kernel) override;
+    void         AddConvolutionEffect(const float* pWeights, size_t kernelSize) override;
+    void         ClearPostprocessEffects() override;
+
+    // Meshes generated while enabled are stored in the shared geometry pool and drawn
+    // with glMultiDrawElementsIndirect, one call per texture set.
+    void         SetMultiDrawIndirect(bool enable) { m_useMultiDrawIndirect = enable; }
+    bool         IsMultiDrawIndirect() const { return m_useMultiDrawIndirect; }
+
+    // Opaque batches are drawn to depth only first, then shaded with GL_EQUAL depth test,
+    // so every visible pixel is shaded once.
+    void         SetDepthPrepass(bool enable) { m_useDepthPrepass = enable; }
+    bool         IsDepthPrepass() const { return m_useDepthPrepass; }
+
+    // Programs built from the shader files changed on disk are recompiled in the background
+    // and replaced once linked. Takes effect in RenderStart.
+    void         SetShaderHotReload(bool enable) { m_useShaderHotReload = enable; }
+    bool         IsShaderHotReload() const { return m_useShaderHotReload; }
+
+    // Linked program binaries are kept there between runs. Takes effect in RenderStart.
+    void         SetShaderCacheDirectory(const std::string& directory) { m_shaderCacheDirectory = directory; }
+
+    // Cooked textures are loaded with their small levels, the larger ones are streamed in when the visible
+    // objects need them. Resident levels are kept within budget bytes, zero means unlimited.
+    // Should be set before the textures are loaded. Stays disabled without bindless textures.
+    void         SetTextureStreaming(bool enable, size_t budget);
+    bool         IsTextureStreaming() const { return m_useTextureStreaming; }
+
+    // Counts of issued and filtered state changes of the last rendered frame.
+    const GLStateStatistics& GetStateStatistics() const { return m_stateCache.GetLastFrameStatistics(); }
+
+    size_t       GenerateMeshRenderData(const Mesh& mesh) override;
+    void         RemoveMeshRenderData(size_t renderDataId) override;
+
+    // Applied to the compiled variants of the main program. Values are kept for the variants
+    // compiled or reloaded later.
+    void         SetShaderUniform(const char* name, bool value);
+    void         SetShaderUniform(const char* name, int value);
+    void         SetShaderUniform(const char* name, float value);
+    void         SetShaderUniform(const char* name, const glm::vec2& value);
+    void         SetShaderUniform(const char* name, float x, float y);
+    void         SetShaderUniform(const char* name, const glm::vec3& value);
+    void         SetShaderUniform(const char* name, float x, float y, float z);
+    void         SetShaderUniform(const char* name, const glm::vec4& value);
+    void         SetShaderUniform(const char* name, float x, float y, float z, float w);
+    void         SetShaderUniform(const char* name, const glm::mat2& mat);
+    void         SetShaderUniform(const char* name, const glm::mat3& mat);
+    void         SetShaderUniform(const char* name, const glm::mat4& mat);
+
+    void         Reset() override;
+
+    void         ClearStoredObjects() override;
+
+    // Generate texture render info.
+    unsigned int GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount) override;
+    unsigned int GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture) override;
+    unsigned int GetStreamedTextureRenderInfo(const char* szCookedPath) override;
+    unsigned int GetQueuedTextureRenderInfo(int width, int height, int channelsCount, TextureDecoder decoder) override;
+    void         DeleteTextureRenderInfo(unsigned int textureId) override;
+
+private:
+    void         Initialize();
+    void         RenderScene(const Scene* scene);
+    void         DrawOpaqueBatches(const MaterialPrograms& programs);
+    // Groups objects into m_instanceBatches and writes their instance data.
+    // Opaque objects sharing mesh and material are merged, transparent ones get a batch each, back to front.
+    bool         BuildInstanceBatches(const std::vector<SceneObject*>& objects);
+    // Registers material for the current frame and returns its index in the materials buffer.
+    size_t       GetMaterialIndex(const Material* pMaterial);
+    // Visible objects request the levels of their textures from their size on screen.
+    void         RequestTextureLevels(const Scene* pScene);
+    void         UploadMaterials();
+    void         UploadLights();
+    // Copies data to the storage ring and binds it to the shader storage binding.
+    void         UploadStorageBlock(GLuint binding, const void* pData, size_t size);
+    // Writes indirect commands of the pooled batches, DrawPooledBatches can then be called once per pass.
+    void         PreparePooledBatches();
+    void         DrawPooledBatches(const MaterialPrograms& programs);
+    // Records draws of the non-pooled opaque batches into m_commandBuffers, in parallel if possible.
+    void         RecordDirectBatches();
+    void         RecordBatches(const std::vector<size_t>& batches, size_t begin, size_t end,
+                               CommandBuffer& commandBuffer) const;
+
+    void         UpdateFrameConstants(const Scene* scene, const glm::mat4& projMatrix);
+    // Point lights go to m_pointLights and are assigned to m_lightClusters.
+    void         UpdateLightsBlock(const Scene* scene, const glm::mat4& projMatrix);
+    // Fills m_mainPrograms and m_depthPrepassPrograms for the material variants used by the frame.
+    void         PrepareMaterialPrograms();
+    // New variants get their uniform values forgotten by the state cache.
+    // Main variants get the values of SetShaderUniform.
+    VSUtils::ShaderProgram* GetProgramVariant(VSUtils::ShaderVariants& variants, uint32_t key);
+    static VSUtils::ShaderProgram* GetPlaceholder(VSUtils::ShaderProgram& program)
+    {
+        return program.GetProgram() != 0 ? &program : nullptr;
+    }
+
+    // Starts reloads of the programs depending on the changed files and swaps in the finished ones.
+    void         UpdateShaderReload();
+    void         ReloadIfChanged(VSUtils::ShaderProgram& program);
+    // Uniforms set once after compilation are set again, post-process passes get the new locations.
+    void         OnProgramReloaded(VSUtils::ShaderProgram& program);
+
+    using UniformSetter = std::function<void(const VSUtils::ShaderProgram& program, GLint location)>;
+    void         StoreShaderUniform(const char* name, UniformSetter setter);
+    void         ApplyShaderUniforms(const VSUtils::ShaderProgram& program) const;
+
+    void         InitializeBuffers();
+    void         UninitializeBuffers();
+    size_t       GetUniformFrameSize() const;
+
+    // Creating a target changes GL bindings behind the state cache.
+    RenderTarget* AcquireRenderTarget(const RenderTargetDesc& desc);
+    // Draws the effects chain from the source target to the default framebuffer and releases the source.
+    void         ApplyPostprocessEffects(RenderTarget* pSourceTarget);
+    // Writes the convolution of the source to the target through image store.
+    void         DispatchConvolution(const PostprocessPass& pass, const RenderTarget* pSourceTarget,
+                                     const RenderTarget* pTarget);
+    // Compiles the program on first use. Returns false if it can't be compiled.
+    bool         PrepareConvolutionProgram(VSUtils::ShaderProgram& program, PostprocessPassType type);
+
+    void         InitializePostProcessData();
+    void         UninitializePostProcessData();
+public:
+    VSUtils::ShaderProgram lightShader;
+
+private:
+    std::unordered_map<size_t, RenderData*> m_renderObjectsMap;
+
+    std::string                             m_shaderCacheDirectory = std::string(ROOT_PATH) + "/ShaderCache";
+    VSUtils::ShaderCache                    m_shaderCache;
+    VSUtils::ShaderCompiler                 m_shaderCompiler;
+
+    // Permutations of the main and the depth pre-pass programs, see MainProgramFlags.
+    VSUtils::ShaderVariants                 m_mainVariants;
+    VSUtils::ShaderVariants                 m_depthPrepassVariants;
+    MaterialPrograms                        m_mainPrograms = {};
+    MaterialPrograms                        m_depthPrepassPrograms = {};
+    // Values of SetShaderUniform by name.
+    std::unordered_map<std::string, UniformSetter> m_shaderUniforms;
+    // Drawn while the variants are compiled.
+    VSUtils::ShaderProgram                  m_placeholderShader;
+    VSUtils::ShaderProgram                  m_depthPlaceholderShader;
+
+    // Hot reload.
+    bool                                    m_useShaderHotReload = false;
+    VSUtils::ShaderWatcher                  m_shaderWatcher;
+    VSUtils::ShaderReloader                 m_shaderReloader;
+    std::vector<std::string>                m_changedShaderFiles;
+    std::vector<VSUtils::ShaderProgram*>    m_reloadedPrograms;
+
+    GLStateCache                            m_stateCache;
+
+    // Profiling. Both do nothing while the profiler is disabled.
+    System::Profiler*                       m_pProfiler = nullptr;
+    GPUTimer                                m_gpuTimer;
+
+    // Instancing. Containers are kept between frames to avoid reallocations.
+    InstanceBuffer                          m_instanceBuffer;
+    std::vector<InstanceBatch>              m_instanceBatches;
+    InstanceBatchIndices                    m_batchIndices;
+    std::vector<size_t>                     m_objectBatchIndices;
+    std::vector<size_t>                     m_directBatches;
+    std::vector<CommandBuffer>              m_commandBuffers;
+
+    // Transparent batches, recorded and drawn in their back to front order.
+    std::vector<size_t>                     m_transparentBatches;
+    CommandBuffer                           m_transparentCommands;
+
+    bool                                    m_useDepthPrepass = false;
+
+    // Materials used by the current frame.
+    MaterialIndices                         m_materialIndices;
+    std::vector<MaterialBlock>              m_materialBlocks;
+    // Material bits of MainProgramFlags by material index.
+    std::vector<uint32_t>                   m_materialVariants;
+    // Textures are referenced by the material blocks, draws don't bind them.
+    MaterialTextures                        m_materialTextures;
+    bool                                    m_useTextureStreaming = false;
+    TextureStreamer                         m_textureStreamer;
+    TextureUploadQueue                      m_textureUploadQueue;
+
+    // Multi-draw indirect.
+    bool                                    m_useMultiDrawIndirect = false;
+    GeometryPool                            m_geometryPool;
+    std::vector<size_t>                     m_pooledBatches;
+    GLintptr                                m_pooledCommandsOffset = 0;
+
+    // Per-frame data. Uniform blocks are bound by ranges of m_uniformRing,
+    // materials, point lights, light clusters and indirect commands live in m_storageRing.
+    FrameConstantsBlock                     m_frameConstants;
+    LightsBlock                             m_lightsBlock;
+    std::vector<PointLightBlock>            m_pointLights;
+    LightClusters                           m_lightClusters;
+    RingBuffer                              m_uniformRing;
+    RingBuffer                              m_storageRing;
+    GLintptr                                m_frameConstantsOffset = 0;
+    GLintptr                                m_lightsOffset = 0;
+    size_t                                  m_uniformAlignment = 1;
+    size_t                                  m_storageAlignment = 1;
+
+    unsigned long                           m_renderDataIDCounter = 0;
+
+    unsigned short                          m_viewportWidth = 0;
+    unsigned short                          m_viewportHeight = 0;
+
+    // Post-process data
+    std::vector<PostprocessPass>            m_postprocessPasses;
+    RenderTargetPool                        m_renderTargetPool;
+    VSUtils::ShaderProgram                  m_separableConvolutionShader;
+    VSUtils::ShaderProgram                  m_convolutionComputeShader;
+
+    GLuint                                  m_screenQuadVAO = 0;
+    GLuint                                  m_screenQuadVBO = 0;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "GLStateCache.h"
+
+#include "ShaderProgram.h"
+
+#include <cstring>
+
+namespace VSEngine {
+
+void GLStateCache::Invalidate()
+{
+    m_isProgramKnown = false;
+    m_isVertexArrayKnown = false;
+    m_isActiveTextureUnitKnown = false;
+
+    for (TextureBinding& binding : m_textureBindings)
+    {
+        binding.isKnown = false;
+    }
+}
+
+void GLStateCache::InvalidateProgram(GLuint program)
+{
+    for (auto valueIter = m_uniformValues.begin(); valueIter != m_uniformValues.end();)
+    {
+        if (static_cast<GLuint>(valueIter->first >> 32) == program)
+        {
+            valueIter = m_uniformValues.erase(valueIter);
+        }
+        else
+        {
+            ++valueIter;
+        }
+    }
+}
+
+void GLStateCache::BeginFrame()
+{
+    m_frameStatistics = GLStateStatistics();
+}
+
+void GLStateCache::EndFrame()
+{
+    m_lastFrameStatistics = m_frameStatistics;
+}
+
+void GLStateCache::UseProgram(const VSUtils::ShaderProgram& program)
+{
+    const GLuint programId = program.GetProgram();
+    if (m_isProgramKnown && m_program == programId)
+    {
+        ++m_frameStatistics.filteredProgramCalls;
+        return;
+    }
+
+    if (program.UseProgram())
+    {
+        m_program = programId;
+        m_isProgramKnown = true;
+        ++m_frameStatistics.programCalls;
+    }
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+    if (m_isVertexArrayKnown && m_vertexArray == vertexArray)
+    {
+        ++m_frameStatistics.filteredVertexArrayCalls;
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+    m_vertexArray = vertexArray;
+    m_isVertexArrayKnown = true;
+    ++m_frameStatistics.vertexArrayCalls;
+}
+
+void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    if (unit < maxTextureUnitsCount)
+    {
+        const TextureBinding& binding = m_textureBindings[unit];
+        if (binding.isKnown && binding.target == target && binding.texture == texture)
+        {
+            ++m_frameStatistics.filteredTextureCalls;
+            return;
+        }
+    }
+
+    if (!m_isActiveTextureUnitKnown || m_activeTextureUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        m_activeTextureUnit = unit;
+        m_isActiveTextureUnitKnown = true;
+        ++m_frameStatistics.textureCalls;
+    }
+
+    glBindTexture(target, texture);
+    ++m_frameStatistics.textureCalls;
+
+    if (unit < maxTextureUnitsCount)
+    {
+        TextureBinding& binding = m_textureBindings[unit];
+        binding.target = target;
+        binding.texture = texture;
+        binding.isKnown = true;
+    }
+}
+
+void GLStateCache::SetInt(const VSUtils::ShaderProgram& program, GLint location, int value)
+{
+    if (UpdateUniform(program.GetProgram(), location, &value, sizeof(value)))
+    {
+        program.SetInt(location, value);
+    }
+}
+
+void GLStateCache::SetFloat(const VSUtils::ShaderProgram& program, GLint location, float value)
+{
+    if (UpdateUniform(program.GetProgram(), location, &value, sizeof(value)))
+    {
+        program.SetFloat(location, value);
+    }
+}
+
+void GLStateCache::SetFloatN(const VSUtils::ShaderProgram& program, GLint location,
+                             const float* pValue, size_t count)
+{
+    if (UpdateUniform(program.GetProgram(), location, pValue, count * sizeof(float)))
+    {
+        program.SetFloatN(location, pValue, count);
+    }
+}
+
+void GLStateCache::SetVec2(const VSUtils::ShaderProgram& program, GLint location, const glm::vec2& value)
+{
+    if (UpdateUniform(program.GetProgram(), location, &value, sizeof(value)))
+    {
+        program.SetVec2(location, value);
+    }
+}
+
+void GLStateCache::SetVec3(const VSUtils::ShaderProgram& program, GLint location, const glm::vec3& value)
+{
+    if (UpdateUniform(program.GetProgram(), location, &value, sizeof(value)))
+    {
+        program.SetVec3(location, value);
+    }
+}
+
+void GLStateCache::SetVec4(const VSUtils::ShaderProgram& program, GLint location, const glm::vec4& value)
+{
+    if (UpdateUniform(program.GetProgram(), location, &value, sizeof(value)))
+    {
+        program.SetVec4(location, value);
+    }
+}
+
+void GLStateCache::SetMat4(const VSUtils::ShaderProgram& program, GLint location, const glm::mat4& value)
+{
+    if (UpdateUniform(program.GetProgram(), location, &value, sizeof(value)))
+    {
+        program.SetMat4(location, value);
+    }
+}
+
+bool GLStateCache::UpdateUniform(GLuint program, GLint location, const void* pValue, size_t size)
+{
+    // Inactive uniform, glUniform* would ignore it anyway.
+    if (location < 0)
+    {
+        ++m_frameStatistics.filteredUniformCalls;
+        return false;
+    }
+
+    if (size > maxUniformSize)
+    {
+        ++m_frameStatistics.uniformCalls;
+        return true;
+    }
+
+    const unsigned long long key = (static_cast<unsigned long long>(program) << 32) |
+                                   static_cast<unsigned long long>(static_cast<GLuint>(location));
+
+    UniformValue& storedValue = m_uniformValues[key];
+    if (storedValue.size == size && std::memcmp(storedValue.data.data(), pValue, size) == 0)
+    {
+        ++m_frameStatistics.filteredUniformCalls;
+        return false;
+    }
+
+    std::memcpy(storedValue.data.data(), pValue, size);
+    storedValue.size = size;
+    ++m_frameStatistics.uniformCalls;
+
+    return true;
+}
+
+}
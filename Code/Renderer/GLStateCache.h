@@ -0,0 +1,107 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+namespace VSUtils {
+class ShaderProgram;
+}
+
+namespace VSEngine {
+
+// Issued and dropped GL calls of a single frame.
+struct GLStateStatistics
+{
+    size_t programCalls = 0;
+    size_t vertexArrayCalls = 0;
+    size_t textureCalls = 0;
+    size_t uniformCalls = 0;
+
+    size_t filteredProgramCalls = 0;
+    size_t filteredVertexArrayCalls = 0;
+    size_t filteredTextureCalls = 0;
+    size_t filteredUniformCalls = 0;
+
+    size_t GetFilteredCallsCount() const
+    {
+        return filteredProgramCalls + filteredVertexArrayCalls + filteredTextureCalls + filteredUniformCalls;
+    }
+};
+
+// Shadow copy of the GL state which the renderer changes every draw. Calls which wouldn't
+// change anything are dropped. Code which changes the same state directly should call Invalidate.
+class GLStateCache
+{
+public:
+    static constexpr size_t maxTextureUnitsCount = 32;
+
+    // Forgets bound objects, so the next bind of each is issued. Uniform values are kept,
+    // they are stored in program objects.
+    void                     Invalidate();
+    // Forgets uniform values of the program. Needed after the program is relinked.
+    void                     InvalidateProgram(GLuint program);
+
+    // Statistics between BeginFrame and EndFrame become available through GetLastFrameStatistics.
+    void                     BeginFrame();
+    void                     EndFrame();
+    const GLStateStatistics& GetLastFrameStatistics() const { return m_lastFrameStatistics; }
+
+    void                     UseProgram(const VSUtils::ShaderProgram& program);
+    void                     BindVertexArray(GLuint vertexArray);
+    // Changes active texture unit only if the binding has to be changed.
+    void                     BindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    void                     SetInt(const VSUtils::ShaderProgram& program, GLint location, int value);
+    void                     SetFloat(const VSUtils::ShaderProgram& program, GLint location, float value);
+    void                     SetFloatN(const VSUtils::ShaderProgram& program, GLint location,
+                                       const float* pValue, size_t count);
+    void                     SetVec2(const VSUtils::ShaderProgram& program, GLint location, const glm::vec2& value);
+    void                     SetVec3(const VSUtils::ShaderProgram& program, GLint location, const glm::vec3& value);
+    void                     SetVec4(const VSUtils::ShaderProgram& program, GLint location, const glm::vec4& value);
+    void                     SetMat4(const VSUtils::ShaderProgram& program, GLint location, const glm::mat4& value);
+
+private:
+    // Bigger values aren't cached and are always uploaded.
+    static constexpr size_t  maxUniformSize = sizeof(glm::mat4);
+
+    struct UniformValue
+    {
+        std::array<unsigned char, maxUniformSize> data;
+        size_t                                    size = 0;
+    };
+
+    // Texture is unknown until the first bind after Invalidate.
+    struct TextureBinding
+    {
+        GLenum target = GL_NONE;
+        GLuint texture = 0;
+        bool   isKnown = false;
+    };
+
+    // Key is program in the high half and location in the low half.
+    using UniformValues = std::unordered_map<unsigned long long, UniformValue>;
+
+    // Returns true if the uniform has to be uploaded. Remembers the new value.
+    bool                     UpdateUniform(GLuint program, GLint location, const void* pValue, size_t size);
+
+private:
+    GLuint                                           m_program = 0;
+    GLuint                                           m_vertexArray = 0;
+    GLuint                                           m_activeTextureUnit = 0;
+    bool                                             m_isProgramKnown = false;
+    bool                                             m_isVertexArrayKnown = false;
+    bool                                             m_isActiveTextureUnitKnown = false;
+    std::array<TextureBinding, maxTextureUnitsCount> m_textureBindings;
+
+    UniformValues                                    m_uniformValues;
+
+    GLStateStatistics                                m_frameStatistics;
+    GLStateStatistics                                m_lastFrameStatistics;
+};
+
+}
@@ -0,0 +1,135 @@
+#include "GPUTimer.h"
+
+#include "Core/System/Profiler.h"
+
+namespace VSEngine {
+
+GPUTimer::~GPUTimer()
+{
+    Uninitialize();
+}
+
+void GPUTimer::Initialize(System::Profiler* pProfiler)
+{
+    m_pProfiler = pProfiler;
+}
+
+void GPUTimer::Uninitialize()
+{
+    for (FrameQueries& frame : m_frames)
+    {
+        for (PassQuery& pass : frame.passes)
+        {
+            glDeleteQueries(1, &pass.query);
+        }
+
+        frame.passes.clear();
+        frame.usedCount = 0;
+        frame.isPending = false;
+    }
+
+    m_pProfiler = nullptr;
+    m_isFrameActive = false;
+    m_isPassActive = false;
+}
+
+void GPUTimer::BeginFrame()
+{
+    if (!IsEnabled())
+        return;
+
+    m_frameIndex = (m_frameIndex + 1) % framesInFlightCount;
+
+    // Older frames are read first, so the samples keep their order. The set to reuse is the oldest one,
+    // it has to be read anyway, the newer ones only if they are ready.
+    FrameQueries& frame = m_frames[m_frameIndex];
+    if (frame.isPending)
+    {
+        ReadFrame(frame, true);
+    }
+
+    for (size_t i = 1; i < framesInFlightCount; ++i)
+    {
+        FrameQueries& newerFrame = m_frames[(m_frameIndex + i) % framesInFlightCount];
+        if (newerFrame.isPending && !ReadFrame(newerFrame, false))
+            break;
+    }
+
+    frame.usedCount = 0;
+    m_isFrameActive = true;
+}
+
+void GPUTimer::EndFrame()
+{
+    if (!m_isFrameActive)
+        return;
+
+    EndPass();
+
+    FrameQueries& frame = m_frames[m_frameIndex];
+    frame.isPending = frame.usedCount > 0;
+    m_isFrameActive = false;
+}
+
+void GPUTimer::BeginPass(const char* name)
+{
+    if (!m_isFrameActive || m_isPassActive)
+        return;
+
+    FrameQueries& frame = m_frames[m_frameIndex];
+    if (frame.usedCount == frame.passes.size())
+    {
+        PassQuery& pass = frame.passes.emplace_back();
+        glGenQueries(1, &pass.query);
+    }
+
+    PassQuery& pass = frame.passes[frame.usedCount++];
+    pass.name = name;
+    pass.submitTime = m_pProfiler->GetTime();
+
+    glBeginQuery(GL_TIME_ELAPSED, pass.query);
+    m_isPassActive = true;
+}
+
+void GPUTimer::EndPass()
+{
+    if (!m_isPassActive)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    m_isPassActive = false;
+}
+
+bool GPUTimer::IsEnabled() const
+{
+    return m_pProfiler && m_pProfiler->IsEnabled();
+}
+
+bool GPUTimer::ReadFrame(FrameQueries& frame, bool wait)
+{
+    if (!wait)
+    {
+        // Queries complete in order, the last one is enough.
+        GLint isAvailable = GL_FALSE;
+        glGetQueryObjectiv(frame.passes[frame.usedCount - 1].query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (isAvailable == GL_FALSE)
+            return false;
+    }
+
+    for (size_t i = 0; i < frame.usedCount; ++i)
+    {
+        const PassQuery& pass = frame.passes[i];
+
+        GLuint64 elapsedTime = 0;
+        glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &elapsedTime);
+
+        // Nanoseconds to microseconds.
+        m_pProfiler->AddGpuSample(pass.name, pass.submitTime, static_cast<double>(elapsedTime) / 1000.0);
+    }
+
+    frame.isPending = false;
+
+    return true;
+}
+
+}
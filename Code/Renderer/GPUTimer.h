@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace VSEngine {
+namespace System {
+class Profiler;
+}
+
+// GL_TIME_ELAPSED queries of named passes, reported to the profiler as GPU samples.
+// Every frame has its own set of queries. Sets are read back without stalls at the beginning
+// of the following frames, usually one frame late; a set is waited for only when it is reused.
+// Elapsed time queries can't be nested, so passes shouldn't overlap.
+class GPUTimer
+{
+public:
+    static constexpr size_t framesInFlightCount = 3;
+
+    GPUTimer() = default;
+    GPUTimer(const GPUTimer& other) = delete;
+    GPUTimer(GPUTimer&& other) = delete;
+    ~GPUTimer();
+
+    GPUTimer& operator=(const GPUTimer& other) = delete;
+    GPUTimer& operator=(GPUTimer&& other) = delete;
+
+    void      Initialize(System::Profiler* pProfiler);
+    void      Uninitialize();
+
+    void      BeginFrame();
+    void      EndFrame();
+
+    // Name should outlive the timer, see Profiler.
+    void      BeginPass(const char* name);
+    void      EndPass();
+
+private:
+    struct PassQuery
+    {
+        GLuint      query = 0;
+        const char* name = nullptr;
+        double      submitTime = 0.0;
+    };
+
+    struct FrameQueries
+    {
+        std::vector<PassQuery> passes;
+        size_t                 usedCount = 0;
+        bool                   isPending = false;
+    };
+
+    bool      IsEnabled() const;
+    // Returns false if results aren't available yet and wait is false.
+    bool      ReadFrame(FrameQueries& frame, bool wait);
+
+private:
+    System::Profiler*                             m_pProfiler = nullptr;
+
+    std::array<FrameQueries, framesInFlightCount> m_frames;
+    size_t                                        m_frameIndex = 0;
+    bool                                          m_isFrameActive = false;
+    bool                                          m_isPassActive = false;
+};
+
+// Measures GPU time of the commands submitted in the enclosing scope.
+class ScopedGPUTimer
+{
+public:
+    ScopedGPUTimer(GPUTimer& timer, const char* name)
+        : m_timer(timer)
+    {
+        m_timer.BeginPass(name);
+    }
+
+    ~ScopedGPUTimer()
+    {
+        m_timer.EndPass();
+    }
+
+    ScopedGPUTimer(const ScopedGPUTimer& other) = delete;
+    ScopedGPUTimer& operator=(const ScopedGPUTimer& other) = delete;
+
+private:
+    GPUTimer& m_timer;
+};
+
+}
@@ -0,0 +1,239 @@
+#include "GeometryPool.h"
+
+#include "InstanceBuffer.h"
+#include "ObjectModel/Mesh.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace VSEngine {
+namespace {
+constexpr size_t initialVerticesCapacity = 1 << 16;
+constexpr size_t initialIndicesCapacity = 1 << 18;
+
+// Binding index of the vertex data in the pool vertex array.
+constexpr GLuint vertexBufferBinding = 0;
+
+static_assert(sizeof(VSUtils::Face) == 3 * sizeof(GLushort), "Faces are uploaded as GL_UNSIGNED_SHORT triples");
+}
+
+GeometryPool::~GeometryPool()
+{
+    Reset();
+}
+
+GeometryAllocation GeometryPool::Allocate(const Mesh& mesh)
+{
+    if (m_vao == 0)
+    {
+        Initialize();
+    }
+
+    const std::vector<Vertex>& vertices = mesh.GetVertices();
+    const std::vector<VSUtils::Face>& faces = mesh.GetFaces();
+    const size_t indicesCount = faces.size() * 3;
+
+    GeometryAllocation allocation;
+    allocation.verticesCount = vertices.size();
+    allocation.indicesCount = indicesCount;
+
+    size_t vertexOffset = m_verticesCount;
+    const bool reusesVertices = TakeFreeRange(m_freeVertices, vertices.size(), vertexOffset);
+    size_t indexOffset = m_indicesCount;
+    const bool reusesIndices = TakeFreeRange(m_freeIndices, indicesCount, indexOffset);
+
+    bool buffersChanged = false;
+    if (!reusesVertices && m_verticesCount + vertices.size() > m_verticesCapacity)
+    {
+        const size_t newCapacity = std::max(m_verticesCount + vertices.size(), m_verticesCapacity * 2);
+        m_vbo = GrowBuffer(m_vbo, m_verticesCount * sizeof(Vertex), newCapacity * sizeof(Vertex));
+        m_verticesCapacity = newCapacity;
+        buffersChanged = true;
+    }
+
+    if (!reusesIndices && m_indicesCount + indicesCount > m_indicesCapacity)
+    {
+        const size_t newCapacity = std::max(m_indicesCount + indicesCount, m_indicesCapacity * 2);
+        m_ebo = GrowBuffer(m_ebo, m_indicesCount * sizeof(GLushort), newCapacity * sizeof(GLushort));
+        m_indicesCapacity = newCapacity;
+        buffersChanged = true;
+    }
+
+    if (buffersChanged)
+    {
+        BindBuffers();
+    }
+
+    // Copy targets don't touch the element array binding of the currently bound vertex array.
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset * sizeof(Vertex),
+                    vertices.size() * sizeof(Vertex), vertices.data());
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset * sizeof(GLushort),
+                    faces.size() * sizeof(VSUtils::Face), faces.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    allocation.baseVertex = static_cast<GLint>(vertexOffset);
+    allocation.firstIndex = static_cast<GLuint>(indexOffset);
+
+    if (!reusesVertices)
+    {
+        m_verticesCount += vertices.size();
+    }
+    if (!reusesIndices)
+    {
+        m_indicesCount += indicesCount;
+    }
+
+    return allocation;
+}
+
+void GeometryPool::Free(const GeometryAllocation& allocation)
+{
+    if (m_vao == 0)
+        return;
+
+    ReleaseRange(m_freeVertices, m_verticesCount, static_cast<size_t>(allocation.baseVertex), allocation.verticesCount);
+    ReleaseRange(m_freeIndices, m_indicesCount, allocation.firstIndex, allocation.indicesCount);
+}
+
+void GeometryPool::Reset()
+{
+    glDeleteVertexArrays(1, &m_vao);
+    glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_ebo);
+
+    m_vao = 0;
+    m_vbo = 0;
+    m_ebo = 0;
+
+    m_verticesCount = 0;
+    m_verticesCapacity = 0;
+    m_indicesCount = 0;
+    m_indicesCapacity = 0;
+
+    m_freeVertices.clear();
+    m_freeIndices.clear();
+}
+
+void GeometryPool::Initialize()
+{
+    m_verticesCapacity = initialVerticesCapacity;
+    m_indicesCapacity = initialIndicesCapacity;
+
+    m_vbo = GrowBuffer(0, 0, m_verticesCapacity * sizeof(Vertex));
+    m_ebo = GrowBuffer(0, 0, m_indicesCapacity * sizeof(GLushort));
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+
+    // Same attribute locations as the per-mesh vertex arrays.
+    glEnableVertexAttribArray(0);
+    glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, static_cast<GLuint>(offsetof(Vertex, point)));
+    glVertexAttribBinding(0, vertexBufferBinding);
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, static_cast<GLuint>(offsetof(Vertex, normal)));
+    glVertexAttribBinding(1, vertexBufferBinding);
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, static_cast<GLuint>(offsetof(Vertex, textureCoord)));
+    glVertexAttribBinding(2, vertexBufferBinding);
+
+    InstanceBuffer::SetupVertexAttributes();
+
+    glBindVertexArray(0);
+
+    BindBuffers();
+}
+
+GLuint GeometryPool::GrowBuffer(GLuint buffer, size_t usedSize, size_t newSize)
+{
+    GLuint newBuffer = 0;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+    if (buffer != 0)
+    {
+        if (usedSize != 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+
+        glDeleteBuffers(1, &buffer);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return newBuffer;
+}
+
+void GeometryPool::BindBuffers()
+{
+    glBindVertexArray(m_vao);
+    glBindVertexBuffer(vertexBufferBinding, m_vbo, 0, sizeof(Vertex));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBindVertexArray(0);
+}
+
+bool GeometryPool::TakeFreeRange(FreeRanges& freeRanges, size_t size, size_t& offset)
+{
+    if (size == 0)
+        return false;
+
+    for (auto rangeIt = freeRanges.begin(); rangeIt != freeRanges.end(); ++rangeIt)
+    {
+        if (rangeIt->second < size)
+            continue;
+
+        offset = rangeIt->first;
+        const size_t restSize = rangeIt->second - size;
+        freeRanges.erase(rangeIt);
+        if (restSize != 0)
+        {
+            freeRanges.emplace(offset + size, restSize);
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void GeometryPool::ReleaseRange(FreeRanges& freeRanges, size_t& usedCount, size_t offset, size_t size)
+{
+    if (size == 0)
+        return;
+
+    auto rangeIt = freeRanges.emplace(offset, size).first;
+
+    auto nextIt = std::next(rangeIt);
+    if (nextIt != freeRanges.end() && rangeIt->first + rangeIt->second == nextIt->first)
+    {
+        rangeIt->second += nextIt->second;
+        freeRanges.erase(nextIt);
+    }
+
+    if (rangeIt != freeRanges.begin())
+    {
+        auto prevIt = std::prev(rangeIt);
+        if (prevIt->first + prevIt->second == rangeIt->first)
+        {
+            prevIt->second += rangeIt->second;
+            freeRanges.erase(rangeIt);
+            rangeIt = prevIt;
+        }
+    }
+
+    if (rangeIt->first + rangeIt->second == usedCount)
+    {
+        usedCount = rangeIt->first;
+        freeRanges.erase(rangeIt);
+    }
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <map>
+
+namespace VSEngine {
+class Mesh;
+
+// Place of a mesh inside the shared buffers.
+struct GeometryAllocation
+{
+    GLint  baseVertex = 0;
+    GLuint firstIndex = 0;
+    size_t verticesCount = 0;
+    size_t indicesCount = 0;
+};
+
+// Large vertex and index buffers shared by static meshes, with a single vertex array.
+// Freed ranges are reused by the next meshes which fit into them, the first fit is taken.
+// Buffers don't shrink, Reset releases all of them.
+class GeometryPool
+{
+public:
+    GeometryPool() = default;
+    GeometryPool(const GeometryPool& other) = delete;
+    GeometryPool(GeometryPool&& other) = delete;
+    ~GeometryPool();
+
+    GeometryPool& operator=(const GeometryPool& other) = delete;
+    GeometryPool& operator=(GeometryPool&& other) = delete;
+
+    // Copies vertices and faces of the mesh into the shared buffers. Buffers grow if needed.
+    GeometryAllocation Allocate(const Mesh& mesh);
+    // Ranges of the mesh can be taken by the next allocations.
+    void               Free(const GeometryAllocation& allocation);
+
+    void               Reset();
+
+    inline GLuint      GetVAO() const { return m_vao; }
+
+private:
+    void               Initialize();
+    // Creates a bigger buffer with the contents of the old one. The old buffer is deleted.
+    GLuint             GrowBuffer(GLuint buffer, size_t usedSize, size_t newSize);
+    void               BindBuffers();
+
+    // Free ranges by their offsets, neighbouring ones are merged.
+    using FreeRanges = std::map<size_t, size_t>;
+    // Takes the first free range of the size. Returns false if none of them fits.
+    static bool        TakeFreeRange(FreeRanges& freeRanges, size_t size, size_t& offset);
+    // Range touching the end of the used part shortens it instead.
+    static void        ReleaseRange(FreeRanges& freeRanges, size_t& usedCount, size_t offset, size_t size);
+
+private:
+    GLuint             m_vao = 0;
+    GLuint             m_vbo = 0;
+    GLuint             m_ebo = 0;
+
+    size_t             m_verticesCount = 0;
+    size_t             m_verticesCapacity = 0;
+    size_t             m_indicesCount = 0;
+    size_t             m_indicesCapacity = 0;
+
+    FreeRanges         m_freeVertices;
+    FreeRanges         m_freeIndices;
+};
+
+}
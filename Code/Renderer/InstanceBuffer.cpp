@@ -0,0 +1,75 @@
+#include "InstanceBuffer.h"
+
+#include <cstdio>
+
+namespace VSEngine {
+
+InstanceBuffer::~InstanceBuffer()
+{
+    Uninitialize();
+}
+
+void InstanceBuffer::Initialize(size_t capacity)
+{
+    m_ringBuffer.Initialize(capacity * sizeof(InstanceData));
+}
+
+void InstanceBuffer::Uninitialize()
+{
+    m_ringBuffer.Uninitialize();
+    m_frameOffset = 0;
+}
+
+InstanceData* InstanceBuffer::BeginFrame(size_t instancesCount)
+{
+    const size_t size = instancesCount * sizeof(InstanceData);
+    m_ringBuffer.BeginFrame(size);
+
+    void* pData = m_ringBuffer.Allocate(size, alignof(InstanceData), m_frameOffset);
+    if (pData == nullptr)
+    {
+        fprintf(stderr, "Failed to allocate %zu instances.\n", instancesCount);
+    }
+
+    return static_cast<InstanceData*>(pData);
+}
+
+void InstanceBuffer::EndFrame()
+{
+    m_ringBuffer.EndFrame();
+}
+
+void InstanceBuffer::SetupVertexAttributes()
+{
+    constexpr GLuint matrixColumnsCount = 4;
+    for (GLuint column = 0; column < matrixColumnsCount; ++column)
+    {
+        const GLuint location = instanceMatrixLocation + column;
+        const GLuint offset = static_cast<GLuint>(offsetof(InstanceData, modelMatrix) + column * sizeof(glm::vec4));
+
+        glEnableVertexAttribArray(location);
+        glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE, offset);
+        glVertexAttribBinding(location, instanceBufferBinding);
+    }
+
+    glEnableVertexAttribArray(instanceColorLocation);
+    glVertexAttribFormat(instanceColorLocation, 4, GL_FLOAT, GL_FALSE,
+                         static_cast<GLuint>(offsetof(InstanceData, color)));
+    glVertexAttribBinding(instanceColorLocation, instanceBufferBinding);
+
+    glEnableVertexAttribArray(instanceMaterialLocation);
+    glVertexAttribIFormat(instanceMaterialLocation, 1, GL_UNSIGNED_INT,
+                          static_cast<GLuint>(offsetof(InstanceData, materialIndex)));
+    glVertexAttribBinding(instanceMaterialLocation, instanceBufferBinding);
+
+    glVertexBindingDivisor(instanceBufferBinding, 1);
+}
+
+void InstanceBuffer::Bind(size_t firstInstance) const
+{
+    glBindVertexBuffer(instanceBufferBinding, m_ringBuffer.GetBuffer(),
+                       m_frameOffset + static_cast<GLintptr>(firstInstance * sizeof(InstanceData)),
+                       sizeof(InstanceData));
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include "RingBuffer.h"
+
+namespace VSEngine {
+
+// Per-instance vertex attributes. Should match Main.vs.glsl.
+constexpr GLuint instanceMatrixLocation = 3; // Takes 4 locations, one per column.
+constexpr GLuint instanceColorLocation = 7;
+constexpr GLuint instanceMaterialLocation = 8;
+
+// Vertex buffer binding index of the instance data. Indices below it are taken by
+// the per-vertex attributes.
+constexpr GLuint instanceBufferBinding = 8;
+
+struct InstanceData
+{
+    glm::mat4    modelMatrix = glm::mat4(1.0f);
+    glm::vec4    color = glm::vec4(0.0f);
+    // Index in the materials storage buffer.
+    unsigned int materialIndex = 0;
+    unsigned int padding[3] = {};
+};
+
+// Per-instance data of the frame in a persistently mapped ring buffer.
+// CPU writes instances directly into the mapped memory, GPU reads them as instanced vertex attributes.
+class InstanceBuffer
+{
+public:
+    InstanceBuffer() = default;
+    InstanceBuffer(const InstanceBuffer& other) = delete;
+    InstanceBuffer(InstanceBuffer&& other) = delete;
+    ~InstanceBuffer();
+
+    InstanceBuffer& operator=(const InstanceBuffer& other) = delete;
+    InstanceBuffer& operator=(InstanceBuffer&& other) = delete;
+
+    void          Initialize(size_t capacity);
+    void          Uninitialize();
+
+    // Returns memory for instancesCount instances. Waits only if GPU still reads the region of this frame.
+    // Buffer grows if needed.
+    InstanceData* BeginFrame(size_t instancesCount);
+    // Called after the last draw which reads the instances.
+    void          EndFrame();
+
+    // Sets up instance attributes of the currently bound vertex array.
+    static void   SetupVertexAttributes();
+
+    // Binds instances starting from firstInstance to the currently bound vertex array.
+    // Indirect draws bind from zero and select instances with baseInstance.
+    void          Bind(size_t firstInstance) const;
+
+private:
+    RingBuffer    m_ringBuffer;
+    GLintptr      m_frameOffset = 0;
+};
+
+}
@@ -0,0 +1,158 @@
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Core/System/JobSystem.h"
+
+namespace VSEngine {
+namespace {
+bool SphereIntersectsBox(const glm::vec3& center, float radius, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+    const glm::vec3 closestPoint = glm::clamp(center, boxMin, boxMax);
+    const glm::vec3 offset = closestPoint - center;
+
+    return glm::dot(offset, offset) <= radius * radius;
+}
+}
+
+void LightClusters::Build(const glm::mat4& projMatrix, unsigned short viewportWidth, unsigned short viewportHeight,
+                          const std::vector<PointLightBlock>& lights, System::JobSystem* pJobSystem)
+{
+    UpdateBounds(projMatrix);
+
+    m_tileScale = glm::vec2(static_cast<float>(gridSizeX) / std::max<float>(viewportWidth, 1.0f),
+                            static_cast<float>(gridSizeY) / std::max<float>(viewportHeight, 1.0f));
+
+    m_clusters.resize(clustersCount);
+
+    auto assignSlices = [this, &lights](size_t begin, size_t end)
+    {
+        for (size_t slice = begin; slice < end; ++slice)
+        {
+            AssignSlice(static_cast<uint32_t>(slice), lights);
+        }
+    };
+
+    if (pJobSystem == nullptr || lights.empty())
+    {
+        assignSlices(0, gridSizeZ);
+    }
+    else
+    {
+        pJobSystem->ParallelFor(gridSizeZ, 1, assignSlices);
+    }
+
+    // Slices are concatenated in order, their cluster offsets become absolute.
+    m_lightIndices.clear();
+    constexpr size_t sliceClustersCount = gridSizeX * gridSizeY;
+    for (uint32_t slice = 0; slice < gridSizeZ; ++slice)
+    {
+        const uint32_t sliceOffset = static_cast<uint32_t>(m_lightIndices.size());
+        for (size_t i = 0; i < sliceClustersCount; ++i)
+        {
+            m_clusters[slice * sliceClustersCount + i].offset += sliceOffset;
+        }
+
+        m_lightIndices.insert(m_lightIndices.end(), m_sliceLightIndices[slice].begin(), m_sliceLightIndices[slice].end());
+    }
+}
+
+void LightClusters::FillLightsBlock(LightsBlock& block) const
+{
+    block.clusterGridSize = glm::uvec4(gridSizeX, gridSizeY, gridSizeZ, 0);
+    block.clusterParameters = glm::vec4(m_tileScale, m_depthScale, m_depthBias);
+}
+
+void LightClusters::UpdateBounds(const glm::mat4& projMatrix)
+{
+    if (projMatrix == m_projMatrix && !m_bounds.empty())
+        return;
+
+    m_projMatrix = projMatrix;
+    m_bounds.resize(clustersCount);
+
+    // Planes of the perspective projection, as built by glm::perspective.
+    const float zNear = projMatrix[3][2] / (projMatrix[2][2] - 1.0f);
+    const float zFar = projMatrix[3][2] / (projMatrix[2][2] + 1.0f);
+
+    // Slice of view depth d is floor(log(d) * scale + bias).
+    const float logDepthRatio = std::log(zFar / zNear);
+    m_depthScale = static_cast<float>(gridSizeZ) / logDepthRatio;
+    m_depthBias = -static_cast<float>(gridSizeZ) * std::log(zNear) / logDepthRatio;
+
+    for (uint32_t slice = 0; slice <= gridSizeZ; ++slice)
+    {
+        m_sliceDepths[slice] = zNear * std::pow(zFar / zNear, static_cast<float>(slice) / gridSizeZ);
+    }
+
+    // View space x of NDC x at depth d is x * d / projMatrix[0][0], the same for y.
+    const glm::vec2 ndcToView(1.0f / projMatrix[0][0], 1.0f / projMatrix[1][1]);
+    const glm::vec2 tileSize(2.0f / gridSizeX, 2.0f / gridSizeY);
+
+    for (uint32_t z = 0; z < gridSizeZ; ++z)
+    {
+        const float nearDepth = m_sliceDepths[z];
+        const float farDepth = m_sliceDepths[z + 1];
+
+        for (uint32_t y = 0; y < gridSizeY; ++y)
+        {
+            for (uint32_t x = 0; x < gridSizeX; ++x)
+            {
+                const glm::vec2 tileMin = glm::vec2(-1.0f) + glm::vec2(x, y) * tileSize;
+                const glm::vec2 tileMax = tileMin + tileSize;
+
+                const glm::vec2 nearMin = tileMin * ndcToView * nearDepth;
+                const glm::vec2 nearMax = tileMax * ndcToView * nearDepth;
+                const glm::vec2 farMin = tileMin * ndcToView * farDepth;
+                const glm::vec2 farMax = tileMax * ndcToView * farDepth;
+
+                ClusterBounds& bounds = m_bounds[x + gridSizeX * (y + gridSizeY * z)];
+                bounds.min = glm::vec3(glm::min(nearMin, farMin), -farDepth);
+                bounds.max = glm::vec3(glm::max(nearMax, farMax), -nearDepth);
+            }
+        }
+    }
+}
+
+void LightClusters::AssignSlice(uint32_t slice, const std::vector<PointLightBlock>& lights)
+{
+    const float nearDepth = m_sliceDepths[slice];
+    const float farDepth = m_sliceDepths[slice + 1];
+
+    // Most of the lights don't reach the slice, the clusters test the rest only.
+    std::vector<uint32_t>& sliceLights = m_sliceLights[slice];
+    sliceLights.clear();
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        const float lightDepth = -lights[i].position.z;
+        if (lightDepth + lights[i].radius >= nearDepth && lightDepth - lights[i].radius <= farDepth)
+        {
+            sliceLights.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    std::vector<uint32_t>& lightIndices = m_sliceLightIndices[slice];
+    lightIndices.clear();
+
+    const size_t firstCluster = static_cast<size_t>(slice) * gridSizeX * gridSizeY;
+    for (size_t cluster = firstCluster; cluster < firstCluster + gridSizeX * gridSizeY; ++cluster)
+    {
+        const ClusterBounds& bounds = m_bounds[cluster];
+        LightClusterBlock& clusterBlock = m_clusters[cluster];
+        clusterBlock.offset = static_cast<uint32_t>(lightIndices.size());
+
+        for (uint32_t lightIndex : sliceLights)
+        {
+            const PointLightBlock& light = lights[lightIndex];
+            if (SphereIntersectsBox(light.position, light.radius, bounds.min, bounds.max))
+            {
+                lightIndices.push_back(lightIndex);
+            }
+        }
+
+        clusterBlock.count = static_cast<uint32_t>(lightIndices.size()) - clusterBlock.offset;
+    }
+}
+
+}
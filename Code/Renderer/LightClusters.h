@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "UniformBlocks.h"
+
+namespace VSEngine {
+namespace System {
+class JobSystem;
+}
+
+// Assigns point lights to the clusters of the view frustum for clustered forward shading.
+// Clusters are screen tiles split into depth slices of exponentially growing thickness.
+// Every cluster gets the range of the indices of the lights whose spheres intersect its view space box.
+// Doesn't call GL: the results are uploaded by the renderer.
+class LightClusters
+{
+public:
+    static constexpr uint32_t gridSizeX = 16;
+    static constexpr uint32_t gridSizeY = 9;
+    static constexpr uint32_t gridSizeZ = 24;
+    static constexpr size_t   clustersCount = gridSizeX * gridSizeY * gridSizeZ;
+
+    // Lights are in view space. Depth slices are assigned in parallel if job system is given.
+    void Build(const glm::mat4& projMatrix, unsigned short viewportWidth, unsigned short viewportHeight,
+               const std::vector<PointLightBlock>& lights, System::JobSystem* pJobSystem);
+
+    // Grid parameters for the lookup in the fragment shader.
+    void FillLightsBlock(LightsBlock& block) const;
+
+    // Indexed by x + gridSizeX * (y + gridSizeY * z).
+    const std::vector<LightClusterBlock>& GetClusters() const { return m_clusters; }
+    const std::vector<uint32_t>&          GetLightIndices() const { return m_lightIndices; }
+
+private:
+    struct ClusterBounds
+    {
+        glm::vec3 min = glm::vec3(0.0f);
+        glm::vec3 max = glm::vec3(0.0f);
+    };
+
+    // Recalculates the boxes if projection has changed.
+    void UpdateBounds(const glm::mat4& projMatrix);
+    void AssignSlice(uint32_t slice, const std::vector<PointLightBlock>& lights);
+
+private:
+    glm::mat4                                          m_projMatrix = glm::mat4(0.0f);
+    std::vector<ClusterBounds>                         m_bounds;
+    std::array<float, gridSizeZ + 1>                   m_sliceDepths = {};
+
+    float                                              m_depthScale = 0.0f;
+    float                                              m_depthBias = 0.0f;
+    glm::vec2                                          m_tileScale = glm::vec2(0.0f);
+
+    std::vector<LightClusterBlock>                     m_clusters;
+    std::vector<uint32_t>                              m_lightIndices;
+
+    // Per slice data, so slices can be processed independently. Cluster offsets are relative to the slice.
+    std::array<std::vector<uint32_t>, gridSizeZ>       m_sliceLights;
+    std::array<std::vector<uint32_t>, gridSizeZ>       m_sliceLightIndices;
+};
+
+}
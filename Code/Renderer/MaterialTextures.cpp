@@ -0,0 +1,563 @@
+#include "MaterialTextures.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "GLStateCache.h"
+
+namespace VSEngine {
+namespace {
+// Arrays double their capacity when they are full.
+constexpr GLsizei initialLayersCount = 4;
+
+GLsizei GetMipmapLevelsCount(GLsizei width, GLsizei height)
+{
+    GLsizei levelsCount = 1;
+    for (GLsizei size = std::max(width, height); size > 1; size /= 2)
+    {
+        ++levelsCount;
+    }
+
+    return levelsCount;
+}
+
+bool GetCompressedFormat(VSUtils::BlockFormat format, GLenum& internalFormat)
+{
+    switch (format)
+    {
+    case VSUtils::BlockFormat::BC1:
+        internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        return GLEW_EXT_texture_compression_s3tc != 0;
+    case VSUtils::BlockFormat::BC3:
+        internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        return GLEW_EXT_texture_compression_s3tc != 0;
+    case VSUtils::BlockFormat::BC4:
+        internalFormat = GL_COMPRESSED_RED_RGTC1;
+        return true;
+    case VSUtils::BlockFormat::BC5:
+        internalFormat = GL_COMPRESSED_RG_RGTC2;
+        return true;
+    case VSUtils::BlockFormat::BC7:
+        internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool GetTextureFormat(int channelsCount, GLenum& internalFormat, GLenum& format)
+{
+    switch (channelsCount)
+    {
+    case 1:
+        internalFormat = GL_R8;
+        format = GL_RED;
+        return true;
+    case 2:
+        internalFormat = GL_RG8;
+        format = GL_RG;
+        return true;
+    case 3:
+        internalFormat = GL_RGB8;
+        format = GL_RGB;
+        return true;
+    case 4:
+        internalFormat = GL_RGBA8;
+        format = GL_RGBA;
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+MaterialTextures::~MaterialTextures()
+{
+    Uninitialize();
+}
+
+void MaterialTextures::Initialize()
+{
+    Uninitialize();
+
+    m_isBindless = GLEW_ARB_bindless_texture != 0;
+
+    GLint maxArrayLayersCount = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrayLayersCount);
+    m_maxArrayLayersCount = static_cast<GLsizei>(maxArrayLayersCount);
+
+    // Rows of the loaded images are tightly packed, odd widths of RGB images aren't padded to 4 bytes.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    printf("Material textures: %s\n", m_isBindless ? "bindless" : "texture arrays");
+}
+
+void MaterialTextures::Uninitialize()
+{
+    for (TextureEntry& entry : m_entries)
+    {
+        if (entry.isUsed && entry.texture != 0)
+        {
+            glMakeTextureHandleNonResidentARB(entry.handle);
+            glDeleteTextures(1, &entry.texture);
+        }
+    }
+
+    for (TextureArray& textureArray : m_arrays)
+    {
+        glDeleteTextures(1, &textureArray.texture);
+    }
+
+    m_arrays.clear();
+    m_entries.clear();
+    m_freeEntries.clear();
+}
+
+GLuint MaterialTextures::AddTexture(const unsigned char* pData, int width, int height, int channelsCount)
+{
+    if (pData == nullptr)
+        return 0;
+
+    const GLuint textureId = ReserveTexture(width, height, channelsCount);
+    if (textureId != 0)
+    {
+        UploadTexture(textureId, pData);
+    }
+
+    return textureId;
+}
+
+GLuint MaterialTextures::ReserveTexture(int width, int height, int channelsCount)
+{
+    GLenum internalFormat = GL_RGBA8;
+    GLenum format = GL_RGBA;
+    if (width <= 0 || height <= 0 || !GetTextureFormat(channelsCount, internalFormat, format))
+        return 0;
+
+    TextureEntry entry;
+    if (m_isBindless)
+    {
+        // Contents of a texture can be changed after its handle is created, unlike its state.
+        CreateBindlessTexture(width, height, internalFormat, entry);
+        if (!MakeResident(entry))
+            return 0;
+    }
+    else if (AllocateLayer(width, height, internalFormat, entry) == nullptr)
+    {
+        return 0;
+    }
+
+    entry.format = format;
+    entry.isReady = false;
+
+    return AddEntry(entry);
+}
+
+void MaterialTextures::UploadTexture(GLuint textureId, const void* pData)
+{
+    if (textureId == 0 || textureId > m_entries.size() || !m_entries[textureId - 1].isUsed ||
+        m_entries[textureId - 1].isCompressed)
+    {
+        return;
+    }
+
+    TextureEntry& entry = m_entries[textureId - 1];
+    if (entry.texture != 0)
+    {
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, entry.width, entry.height, entry.format, GL_UNSIGNED_BYTE, pData);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    else
+    {
+        TextureArray& textureArray = m_arrays[entry.arrayIndex];
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, entry.layer, entry.width, entry.height, 1,
+                        entry.format, GL_UNSIGNED_BYTE, pData);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        textureArray.hasDirtyMipmaps = true;
+    }
+
+    entry.isReady = true;
+}
+
+GLuint MaterialTextures::AddCompressedTexture(const VSUtils::CompressedTexture& texture)
+{
+    GLenum internalFormat = GL_NONE;
+    if (texture.levels.empty() || !GetCompressedFormat(texture.format, internalFormat))
+        return 0;
+
+    const GLsizei width = texture.levels.front().width;
+    const GLsizei height = texture.levels.front().height;
+
+    // Mipmaps of compressed textures can't be generated, arrays need all the levels.
+    if (static_cast<GLsizei>(texture.levels.size()) < GetMipmapLevelsCount(width, height))
+    {
+        fprintf(stderr, "Compressed %dx%d texture has %zu mip levels, the complete chain is required\n",
+                width, height, texture.levels.size());
+        return 0;
+    }
+
+    TextureEntry entry;
+    entry.isCompressed = true;
+    if (!CreateCompressedStorage(width, height, internalFormat, entry))
+        return 0;
+
+    UploadLevels(entry, texture.levels, GetMipmapLevelsCount(width, height));
+
+    if (!FinishCompressedStorage(entry))
+        return 0;
+
+    return AddEntry(entry);
+}
+
+bool MaterialTextures::AddTopLevels(GLuint textureId, const std::vector<VSUtils::CompressedLevel>& levels)
+{
+    if (levels.empty())
+        return false;
+
+    return Rebase(textureId, levels.front().width, levels.front().height, levels);
+}
+
+bool MaterialTextures::DropTopLevels(GLuint textureId, GLsizei levelsCount)
+{
+    if (textureId == 0 || textureId > m_entries.size() || !m_entries[textureId - 1].isUsed)
+        return false;
+
+    const TextureEntry& entry = m_entries[textureId - 1];
+    if (levelsCount <= 0 || levelsCount >= GetMipmapLevelsCount(entry.width, entry.height))
+        return false;
+
+    return Rebase(textureId, std::max(entry.width >> levelsCount, 1), std::max(entry.height >> levelsCount, 1), {});
+}
+
+bool MaterialTextures::IsFormatSupported(VSUtils::BlockFormat format)
+{
+    GLenum internalFormat = GL_NONE;
+    return GetCompressedFormat(format, internalFormat);
+}
+
+void MaterialTextures::RemoveTexture(GLuint textureId)
+{
+    if (textureId == 0 || textureId > m_entries.size() || !m_entries[textureId - 1].isUsed)
+        return;
+
+    TextureEntry& entry = m_entries[textureId - 1];
+    ReleaseStorage(entry);
+
+    entry = TextureEntry();
+    m_freeEntries.push_back(textureId - 1);
+}
+
+bool MaterialTextures::GetReference(GLuint textureId, glm::uvec2& reference) const
+{
+    if (textureId == 0 || textureId > m_entries.size() || !m_entries[textureId - 1].isUsed ||
+        !m_entries[textureId - 1].isReady)
+    {
+        return false;
+    }
+
+    const TextureEntry& entry = m_entries[textureId - 1];
+    if (entry.texture != 0)
+    {
+        reference = glm::uvec2(static_cast<uint32_t>(entry.handle), static_cast<uint32_t>(entry.handle >> 32));
+    }
+    else
+    {
+        reference = glm::uvec2(entry.arrayIndex, static_cast<uint32_t>(entry.layer));
+    }
+
+    return true;
+}
+
+void MaterialTextures::BuildMipmaps()
+{
+    // Layers are added one by one while a model is loaded, the levels are built once for all of them.
+    for (TextureArray& textureArray : m_arrays)
+    {
+        if (!textureArray.hasDirtyMipmaps)
+            continue;
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray.texture);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        textureArray.hasDirtyMipmaps = false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void MaterialTextures::Bind(GLStateCache& stateCache) const
+{
+    for (size_t arrayIndex = 0; arrayIndex < m_arrays.size(); ++arrayIndex)
+    {
+        stateCache.BindTexture(static_cast<GLuint>(arrayIndex), GL_TEXTURE_2D_ARRAY, m_arrays[arrayIndex].texture);
+    }
+}
+
+GLuint MaterialTextures::AddEntry(const TextureEntry& entry)
+{
+    size_t entryIndex = m_entries.size();
+    if (m_freeEntries.empty())
+    {
+        m_entries.push_back(entry);
+    }
+    else
+    {
+        entryIndex = m_freeEntries.back();
+        m_freeEntries.pop_back();
+        m_entries[entryIndex] = entry;
+    }
+
+    m_entries[entryIndex].isUsed = true;
+
+    return static_cast<GLuint>(entryIndex + 1);
+}
+
+void MaterialTextures::ReleaseStorage(const TextureEntry& entry)
+{
+    if (entry.texture != 0)
+    {
+        glMakeTextureHandleNonResidentARB(entry.handle);
+        glDeleteTextures(1, &entry.texture);
+    }
+    else
+    {
+        // Layer keeps its contents until it's taken again, no material references it.
+        m_arrays[entry.arrayIndex].freeLayers.push_back(entry.layer);
+    }
+}
+
+bool MaterialTextures::CreateCompressedStorage(GLsizei width, GLsizei height, GLenum internalFormat,
+                                               TextureEntry& entry)
+{
+    if (m_isBindless)
+    {
+        CreateBindlessTexture(width, height, internalFormat, entry);
+        return true;
+    }
+
+    TextureArray* pArray = AllocateLayer(width, height, internalFormat, entry);
+    if (pArray == nullptr)
+        return false;
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, pArray->texture);
+
+    return true;
+}
+
+bool MaterialTextures::FinishCompressedStorage(TextureEntry& entry)
+{
+    if (entry.texture != 0)
+        return MakeResident(entry);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    return true;
+}
+
+void MaterialTextures::UploadLevels(const TextureEntry& entry, const std::vector<VSUtils::CompressedLevel>& levels,
+                                    GLsizei levelsCount)
+{
+    for (GLsizei levelIndex = 0; levelIndex < levelsCount; ++levelIndex)
+    {
+        const VSUtils::CompressedLevel& level = levels[levelIndex];
+        const GLsizei dataSize = static_cast<GLsizei>(level.data.size());
+        if (entry.texture != 0)
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, levelIndex, 0, 0, level.width, level.height,
+                                      entry.internalFormat, dataSize, level.data.data());
+        }
+        else
+        {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, levelIndex, 0, 0, entry.layer, level.width, level.height, 1,
+                                      entry.internalFormat, dataSize, level.data.data());
+        }
+    }
+}
+
+bool MaterialTextures::Rebase(GLuint textureId, GLsizei width, GLsizei height,
+                              const std::vector<VSUtils::CompressedLevel>& topLevels)
+{
+    if (textureId == 0 || textureId > m_entries.size() || !m_entries[textureId - 1].isUsed ||
+        !m_entries[textureId - 1].isCompressed)
+    {
+        return false;
+    }
+
+    const TextureEntry oldEntry = m_entries[textureId - 1];
+
+    // Level i of the new storage is level i + levelShift of the old one.
+    const GLsizei levelsCount = GetMipmapLevelsCount(width, height);
+    const GLsizei levelShift = GetMipmapLevelsCount(oldEntry.width, oldEntry.height) - levelsCount;
+    const GLsizei uploadedCount = static_cast<GLsizei>(topLevels.size());
+    if (uploadedCount > levelsCount || uploadedCount + levelShift < 0)
+        return false;
+
+    TextureEntry newEntry;
+    newEntry.isCompressed = true;
+    if (!CreateCompressedStorage(width, height, oldEntry.internalFormat, newEntry))
+        return false;
+
+    UploadLevels(newEntry, topLevels, uploadedCount);
+
+    // Arrays could be reallocated by the layer allocation, textures are taken after it.
+    const GLenum target = m_isBindless ? GL_TEXTURE_2D : GL_TEXTURE_2D_ARRAY;
+    const GLuint oldTexture = m_isBindless ? oldEntry.texture : m_arrays[oldEntry.arrayIndex].texture;
+    const GLuint newTexture = m_isBindless ? newEntry.texture : m_arrays[newEntry.arrayIndex].texture;
+    for (GLsizei level = uploadedCount; level < levelsCount; ++level)
+    {
+        glCopyImageSubData(oldTexture, target, level + levelShift, 0, 0, oldEntry.layer,
+                           newTexture, target, level, 0, 0, newEntry.layer,
+                           std::max(width >> level, 1), std::max(height >> level, 1), 1);
+    }
+
+    if (!FinishCompressedStorage(newEntry))
+        return false;
+
+    ReleaseStorage(oldEntry);
+
+    newEntry.isUsed = true;
+    m_entries[textureId - 1] = newEntry;
+
+    return true;
+}
+
+void MaterialTextures::CreateBindlessTexture(GLsizei width, GLsizei height, GLenum internalFormat,
+                                             TextureEntry& entry)
+{
+    entry.width = width;
+    entry.height = height;
+    entry.internalFormat = internalFormat;
+
+    glGenTextures(1, &entry.texture);
+    glBindTexture(GL_TEXTURE_2D, entry.texture);
+    glTexStorage2D(GL_TEXTURE_2D, GetMipmapLevelsCount(width, height), internalFormat, width, height);
+    SetSamplingParameters(GL_TEXTURE_2D);
+}
+
+bool MaterialTextures::MakeResident(TextureEntry& entry)
+{
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // State of the texture is frozen once it has a handle.
+    entry.handle = glGetTextureHandleARB(entry.texture);
+    if (entry.handle == 0)
+    {
+        fprintf(stderr, "Bindless texture handle isn't created\n");
+        glDeleteTextures(1, &entry.texture);
+        entry.texture = 0;
+        return false;
+    }
+
+    glMakeTextureHandleResidentARB(entry.handle);
+
+    return true;
+}
+
+MaterialTextures::TextureArray* MaterialTextures::AllocateLayer(GLsizei width, GLsizei height, GLenum internalFormat,
+                                                                TextureEntry& entry)
+{
+    TextureArray* pArray = FindArray(width, height, internalFormat);
+    if (pArray == nullptr)
+    {
+        fprintf(stderr, "Texture arrays are limited to %zu sizes and formats, %dx%d texture is dropped\n",
+                maxTextureArraysCount, width, height);
+        return nullptr;
+    }
+
+    GLsizei layer = pArray->usedLayersCount;
+    if (!pArray->freeLayers.empty())
+    {
+        layer = pArray->freeLayers.back();
+        pArray->freeLayers.pop_back();
+    }
+    else
+    {
+        if (layer >= m_maxArrayLayersCount)
+        {
+            fprintf(stderr, "Texture array of %dx%d textures is full\n", width, height);
+            return nullptr;
+        }
+
+        if (layer == pArray->capacity)
+        {
+            GrowArray(*pArray, std::min(std::max(pArray->capacity * 2, initialLayersCount), m_maxArrayLayersCount));
+        }
+
+        ++pArray->usedLayersCount;
+    }
+
+    entry.arrayIndex = static_cast<uint32_t>(pArray - m_arrays.data());
+    entry.layer = layer;
+    entry.width = width;
+    entry.height = height;
+    entry.internalFormat = internalFormat;
+
+    return pArray;
+}
+
+MaterialTextures::TextureArray* MaterialTextures::FindArray(GLsizei width, GLsizei height, GLenum internalFormat)
+{
+    for (TextureArray& textureArray : m_arrays)
+    {
+        if (textureArray.width == width && textureArray.height == height &&
+            textureArray.internalFormat == internalFormat)
+        {
+            return &textureArray;
+        }
+    }
+
+    if (m_arrays.size() >= maxTextureArraysCount)
+        return nullptr;
+
+    TextureArray& textureArray = m_arrays.emplace_back();
+    textureArray.width = width;
+    textureArray.height = height;
+    textureArray.internalFormat = internalFormat;
+    textureArray.levelsCount = GetMipmapLevelsCount(width, height);
+
+    return &textureArray;
+}
+
+void MaterialTextures::GrowArray(TextureArray& textureArray, GLsizei capacity)
+{
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, textureArray.levelsCount, textureArray.internalFormat,
+                   textureArray.width, textureArray.height, capacity);
+    SetSamplingParameters(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (textureArray.texture != 0)
+    {
+        // Mipmaps which aren't built yet are built for the new texture by BuildMipmaps.
+        GLsizei width = textureArray.width;
+        GLsizei height = textureArray.height;
+        for (GLsizei level = 0; level < textureArray.levelsCount; ++level)
+        {
+            glCopyImageSubData(textureArray.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                               texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+                               width, height, textureArray.usedLayersCount);
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+
+        glDeleteTextures(1, &textureArray.texture);
+    }
+
+    textureArray.texture = texture;
+    textureArray.capacity = capacity;
+}
+
+void MaterialTextures::SetSamplingParameters(GLenum target)
+{
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Utils/TextureCompression.h"
+
+namespace VSEngine {
+class GLStateCache;
+
+// Storage of the material textures which lets a draw sample any of them without binding it.
+// With ARB_bindless_texture every texture is separate and referenced by its resident handle.
+// Otherwise textures of the same size and format are layers of a texture array, and the arrays
+// are bound once per frame to consecutive units. Either way a texture is referenced by a uvec2,
+// see MaterialBlock and Include/Materials.glsl.
+class MaterialTextures
+{
+public:
+    // Should match MAX_TEXTURE_ARRAYS of Include/Materials.glsl.
+    static constexpr size_t maxTextureArraysCount = 16;
+
+    MaterialTextures() = default;
+    MaterialTextures(const MaterialTextures& other) = delete;
+    MaterialTextures(MaterialTextures&& other) = delete;
+    ~MaterialTextures();
+
+    MaterialTextures& operator=(const MaterialTextures& other) = delete;
+    MaterialTextures& operator=(MaterialTextures&& other) = delete;
+
+    // Picks bindless textures if they are supported.
+    void       Initialize();
+    void       Uninitialize();
+
+    bool       IsBindless() const { return m_isBindless; }
+
+    // Returns the id of the texture, 0 if it can't be stored.
+    GLuint     AddTexture(const unsigned char* pData, int width, int height, int channelsCount);
+    // Allocates the storage and the id of the texture, its data is given to UploadTexture later.
+    // Texture has no reference until then.
+    GLuint     ReserveTexture(int width, int height, int channelsCount);
+    // Data is a client pointer or an offset into the buffer bound to GL_PIXEL_UNPACK_BUFFER.
+    void       UploadTexture(GLuint textureId, const void* pData);
+    // Levels are uploaded as they are. Returns 0 if the format isn't supported or the mip chain isn't complete.
+    GLuint     AddCompressedTexture(const VSUtils::CompressedTexture& texture);
+    static bool IsFormatSupported(VSUtils::BlockFormat format);
+    // Streaming of compressed textures: the texture is recreated with another base level and the levels
+    // it keeps are copied on the GPU. Id stays the same, the reference changes.
+    // Levels are the new top ones, from the largest, and should continue the resident chain.
+    bool       AddTopLevels(GLuint textureId, const std::vector<VSUtils::CompressedLevel>& levels);
+    bool       DropTopLevels(GLuint textureId, GLsizei levelsCount);
+    void       RemoveTexture(GLuint textureId);
+
+    // Reference of the texture for the shaders: array and layer, or the bindless handle split in halves.
+    // Returns false for 0, removed and not yet uploaded textures.
+    bool       GetReference(GLuint textureId, glm::uvec2& reference) const;
+
+    // Builds the mipmaps of the arrays which got new layers. Binds textures behind the state cache.
+    void       BuildMipmaps();
+    // Binds the arrays to the units from 0, once per frame. Nothing to bind for bindless textures.
+    void       Bind(GLStateCache& stateCache) const;
+
+    size_t     GetTextureArraysCount() const { return m_arrays.size(); }
+
+private:
+    struct TextureArray
+    {
+        GLuint                texture = 0;
+        GLsizei               width = 0;
+        GLsizei               height = 0;
+        GLenum                internalFormat = GL_RGBA8;
+        GLsizei               levelsCount = 1;
+        GLsizei               capacity = 0;
+        GLsizei               usedLayersCount = 0;
+        std::vector<GLsizei>  freeLayers;
+        bool                  hasDirtyMipmaps = false;
+    };
+
+    struct TextureEntry
+    {
+        // Bindless texture and its handle.
+        GLuint                texture = 0;
+        GLuint64              handle = 0;
+        // Layer of the array.
+        uint32_t              arrayIndex = 0;
+        GLsizei               layer = 0;
+        // Base level.
+        GLsizei               width = 0;
+        GLsizei               height = 0;
+        GLenum                internalFormat = GL_RGBA8;
+        // Pixel format of the uploaded data of uncompressed textures.
+        GLenum                format = GL_RGBA;
+        // Levels of compressed textures are uploaded, the others are generated.
+        bool                  isCompressed = false;
+        bool                  isReady = true;
+        bool                  isUsed = false;
+    };
+
+    GLuint     AddEntry(const TextureEntry& entry);
+    void       ReleaseStorage(const TextureEntry& entry);
+    // Storage of compressed textures is bound by Create and unbound by Finish, levels are uploaded in between.
+    bool       CreateCompressedStorage(GLsizei width, GLsizei height, GLenum internalFormat, TextureEntry& entry);
+    bool       FinishCompressedStorage(TextureEntry& entry);
+    void       UploadLevels(const TextureEntry& entry, const std::vector<VSUtils::CompressedLevel>& levels,
+                            GLsizei levelsCount);
+    // Recreates the texture with the base level of the size, see AddTopLevels.
+    bool       Rebase(GLuint textureId, GLsizei width, GLsizei height,
+                      const std::vector<VSUtils::CompressedLevel>& topLevels);
+    // Allocates the storage of all levels and leaves the texture bound, MakeResident follows the upload.
+    void       CreateBindlessTexture(GLsizei width, GLsizei height, GLenum internalFormat, TextureEntry& entry);
+    bool       MakeResident(TextureEntry& entry);
+    // Takes a free layer of the array of the size and format. Returns nullptr if there is no room.
+    TextureArray* AllocateLayer(GLsizei width, GLsizei height, GLenum internalFormat, TextureEntry& entry);
+    // Returns nullptr if all the array units are taken.
+    TextureArray* FindArray(GLsizei width, GLsizei height, GLenum internalFormat);
+    // Reallocates the array, existing layers are copied.
+    void       GrowArray(TextureArray& textureArray, GLsizei capacity);
+
+    static void SetSamplingParameters(GLenum target);
+
+private:
+    bool                      m_isBindless = false;
+    GLsizei                   m_maxArrayLayersCount = 0;
+
+    std::vector<TextureArray> m_arrays;
+    // Texture id is the index of its entry plus one.
+    std::vector<TextureEntry> m_entries;
+    std::vector<size_t>       m_freeEntries;
+};
+
+}
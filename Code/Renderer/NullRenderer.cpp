@@ -0,0 +1,32 @@
+#include "NullRenderer.h"
+
+#include "ObjectModel/Mesh.h"
+#include "Utils/TextureCompression.h"
+
+namespace VSEngine {
+
+size_t NullRenderer::GenerateMeshRenderData(const Mesh& mesh)
+{
+    if (mesh.GetMeshRenderDataId())
+        return mesh.GetMeshRenderDataId();
+
+    return ++m_renderDataIDCounter;
+}
+
+unsigned int NullRenderer::GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount)
+{
+    if (data == nullptr)
+        return 0;
+
+    return ++m_textureIDCounter;
+}
+
+unsigned int NullRenderer::GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture)
+{
+    if (texture.levels.empty())
+        return 0;
+
+    return ++m_textureIDCounter;
+}
+
+}
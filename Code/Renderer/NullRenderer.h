@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Renderer.h"
+
+namespace VSEngine {
+
+// Renderer which never touches the GPU. Hands out unique ids for meshes and textures,
+// so the scene, culling and resource code run exactly as with the real backend.
+class NullRenderer : public Renderer
+{
+public:
+    NullRenderer() = default;
+    ~NullRenderer() override = default;
+
+    void         ChangeViewportSize(unsigned short width, unsigned short height) override {}
+
+    void         Render(double time, const Scene* scene, const glm::mat4& projMatrix) override {}
+    void         RenderStart() override {}
+    void         RenderFinish() override {}
+
+    void         AddPostprocessEffect(const char* szVertexShaderPath, const char* szFragmentShaderPath,
+                                      const glm::mat3& kernel) override {}
+    void         AddConvolutionEffect(const float* pWeights, size_t kernelSize) override {}
+    void         ClearPostprocessEffects() override {}
+
+    size_t       GenerateMeshRenderData(const Mesh& mesh) override;
+    void         RemoveMeshRenderData(size_t renderDataId) override {}
+
+    void         Reset() override {}
+
+    void         ClearStoredObjects() override {}
+
+    unsigned int GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount) override;
+    unsigned int GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture) override;
+    unsigned int GetStreamedTextureRenderInfo(const char* szCookedPath) override { return 0; }
+    unsigned int GetQueuedTextureRenderInfo(int width, int height, int channelsCount, TextureDecoder decoder) override
+    {
+        return 0;
+    }
+    void         DeleteTextureRenderInfo(unsigned int textureId) override {}
+
+private:
+    size_t       m_renderDataIDCounter = 0;
+    unsigned int m_textureIDCounter = 0;
+};
+
+}
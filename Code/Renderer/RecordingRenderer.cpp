@@ -0,0 +1,87 @@
+#include "RecordingRenderer.h"
+
+#include "ObjectModel/Mesh.h"
+#include "Scene/Scene.h"
+#include "Scene/Components/SceneObject.h"
+
+namespace VSEngine {
+
+void RecordingRenderer::Render(double time, const Scene* scene, const glm::mat4& projMatrix)
+{
+    m_commands.clear();
+
+    RenderCommand& beginCommand = m_commands.emplace_back();
+    beginCommand.type = RenderCommandType::BeginFrame;
+
+    size_t facesCount = 0;
+    const std::vector<SceneObject*>& sceneObjects = scene->GetSceneObjects();
+    for (const SceneObject* pObject : sceneObjects)
+    {
+        const Mesh& mesh = pObject->GetMesh();
+
+        RenderCommand& drawCommand = m_commands.emplace_back();
+        drawCommand.type = RenderCommandType::Draw;
+        drawCommand.pObject = pObject;
+        drawCommand.pMaterial = mesh.GetMaterial();
+        drawCommand.renderDataId = mesh.GetMeshRenderDataId();
+        drawCommand.facesCount = mesh.FacesCount();
+
+        facesCount += drawCommand.facesCount;
+    }
+
+    RenderCommand& endCommand = m_commands.emplace_back();
+    endCommand.type = RenderCommandType::EndFrame;
+
+    ++m_statistics.framesCount;
+    m_statistics.drawsCount = sceneObjects.size();
+    m_statistics.facesCount = facesCount;
+}
+
+size_t RecordingRenderer::GenerateMeshRenderData(const Mesh& mesh)
+{
+    if (mesh.GetMeshRenderDataId())
+        return mesh.GetMeshRenderDataId();
+
+    ++m_statistics.meshesCount;
+    return NullRenderer::GenerateMeshRenderData(mesh);
+}
+
+void RecordingRenderer::RemoveMeshRenderData(size_t renderDataId)
+{
+    if (renderDataId != 0 && m_statistics.meshesCount != 0)
+    {
+        --m_statistics.meshesCount;
+    }
+}
+
+unsigned int RecordingRenderer::GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount)
+{
+    const unsigned int textureId = NullRenderer::GetTextureRenderInfo(data, width, height, channelsCount);
+    if (textureId != 0)
+    {
+        ++m_statistics.texturesCount;
+    }
+
+    return textureId;
+}
+
+unsigned int RecordingRenderer::GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture)
+{
+    const unsigned int textureId = NullRenderer::GetCompressedTextureRenderInfo(texture);
+    if (textureId != 0)
+    {
+        ++m_statistics.texturesCount;
+    }
+
+    return textureId;
+}
+
+void RecordingRenderer::DeleteTextureRenderInfo(unsigned int textureId)
+{
+    if (textureId != 0 && m_statistics.texturesCount != 0)
+    {
+        --m_statistics.texturesCount;
+    }
+}
+
+}
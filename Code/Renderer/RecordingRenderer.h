@@ -0,0 +1,63 @@
+#pragma once
+
+#include "NullRenderer.h"
+
+#include <vector>
+
+namespace VSEngine {
+class Material;
+class SceneObject;
+
+enum class RenderCommandType : char
+{
+    BeginFrame,
+    Draw,
+    EndFrame
+};
+
+struct RenderCommand
+{
+    RenderCommandType  type = RenderCommandType::Draw;
+    const SceneObject* pObject = nullptr;
+    const Material*    pMaterial = nullptr;
+    size_t             renderDataId = 0;
+    size_t             facesCount = 0;
+};
+
+struct RenderStatistics
+{
+    size_t framesCount = 0;
+    // Last frame only.
+    size_t drawsCount = 0;
+    size_t facesCount = 0;
+    // Currently alive GPU resources.
+    size_t meshesCount = 0;
+    size_t texturesCount = 0;
+};
+
+// Null renderer which records what would have been submitted to the GPU.
+// Only the commands of the last rendered frame are kept, so memory doesn't grow in soak tests.
+class RecordingRenderer final : public NullRenderer
+{
+public:
+    RecordingRenderer() = default;
+    ~RecordingRenderer() override = default;
+
+    void                              Render(double time, const Scene* scene, const glm::mat4& projMatrix) override;
+
+    size_t                            GenerateMeshRenderData(const Mesh& mesh) override;
+    void                              RemoveMeshRenderData(size_t renderDataId) override;
+
+    unsigned int                      GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount) override;
+    unsigned int                      GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture) override;
+    void                              DeleteTextureRenderInfo(unsigned int textureId) override;
+
+    const std::vector<RenderCommand>& GetRecordedCommands() const { return m_commands; }
+    const RenderStatistics&           GetStatistics() const { return m_statistics; }
+
+private:
+    std::vector<RenderCommand> m_commands;
+    RenderStatistics           m_statistics;
+};
+
+}
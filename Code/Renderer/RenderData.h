@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace VSEngine {
 struct RenderData final
 {
@@ -8,5 +10,13 @@ struct RenderData final
     unsigned int vao = 0;
     unsigned int vbo = 0;
     unsigned int ebo = 0;
+
+    // Meshes from the geometry pool have no own buffers and are drawn with multi-draw indirect.
+    bool         isPooled = false;
+    int          baseVertex = 0;
+    unsigned int firstIndex = 0;
+    // Sizes of the ranges in the pool, they are given back on removal.
+    size_t       verticesCount = 0;
+    size_t       indicesCount = 0;
 };
 }
\ No newline at end of file
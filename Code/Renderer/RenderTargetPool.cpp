@@ -0,0 +1,108 @@
+#include "RenderTargetPool.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace VSEngine {
+
+RenderTargetPool::~RenderTargetPool()
+{
+    Clear();
+}
+
+RenderTarget* RenderTargetPool::Acquire(const RenderTargetDesc& desc)
+{
+    for (RenderTarget* pTarget : m_targets)
+    {
+        if (!pTarget->isInUse && pTarget->desc == desc)
+        {
+            pTarget->isInUse = true;
+            return pTarget;
+        }
+    }
+
+    RenderTarget* pTarget = CreateTarget(desc);
+    if (pTarget == nullptr)
+        return nullptr;
+
+    pTarget->isInUse = true;
+    m_targets.push_back(pTarget);
+
+    return pTarget;
+}
+
+void RenderTargetPool::Release(RenderTarget* pTarget)
+{
+    if (pTarget)
+    {
+        pTarget->isInUse = false;
+    }
+}
+
+void RenderTargetPool::Trim()
+{
+    auto unusedBegin = std::stable_partition(m_targets.begin(), m_targets.end(), [](const RenderTarget* pTarget)
+    {
+        return pTarget->isInUse;
+    });
+
+    std::for_each(unusedBegin, m_targets.end(), DeleteTarget);
+    m_targets.erase(unusedBegin, m_targets.end());
+}
+
+void RenderTargetPool::Clear()
+{
+    std::for_each(m_targets.begin(), m_targets.end(), DeleteTarget);
+    m_targets.clear();
+}
+
+RenderTarget* RenderTargetPool::CreateTarget(const RenderTargetDesc& desc)
+{
+    RenderTarget* pTarget = new RenderTarget();
+    pTarget->desc = desc;
+
+    glGenFramebuffers(1, &pTarget->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, pTarget->framebuffer);
+
+    glGenTextures(1, &pTarget->colorTexture);
+    glBindTexture(GL_TEXTURE_2D, pTarget->colorTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, desc.colorFormat, desc.width, desc.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pTarget->colorTexture, 0);
+
+    if (desc.hasDepthStencil)
+    {
+        glGenRenderbuffers(1, &pTarget->depthStencilRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, pTarget->depthStencilRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, desc.width, desc.height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                                  pTarget->depthStencilRenderbuffer);
+    }
+
+    const bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!isComplete)
+    {
+        fprintf(stderr, "Render target %ux%u is not complete\n",
+                static_cast<unsigned int>(desc.width), static_cast<unsigned int>(desc.height));
+        DeleteTarget(pTarget);
+        return nullptr;
+    }
+
+    return pTarget;
+}
+
+void RenderTargetPool::DeleteTarget(RenderTarget* pTarget)
+{
+    glDeleteRenderbuffers(1, &pTarget->depthStencilRenderbuffer);
+    glDeleteTextures(1, &pTarget->colorTexture);
+    glDeleteFramebuffers(1, &pTarget->framebuffer);
+
+    delete pTarget;
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace VSEngine {
+
+struct RenderTargetDesc
+{
+    unsigned short width = 0;
+    unsigned short height = 0;
+    GLenum         colorFormat = GL_RGBA8;
+    bool           hasDepthStencil = false;
+
+    bool operator==(const RenderTargetDesc& other) const
+    {
+        return width == other.width && height == other.height &&
+               colorFormat == other.colorFormat && hasDepthStencil == other.hasDepthStencil;
+    }
+};
+
+// Framebuffer with a color texture and an optional depth-stencil renderbuffer.
+struct RenderTarget
+{
+    RenderTargetDesc desc;
+    GLuint           framebuffer = 0;
+    GLuint           colorTexture = 0;
+    GLuint           depthStencilRenderbuffer = 0;
+    bool             isInUse = false;
+};
+
+// Render targets borrowed for the duration of a pass. A released target is handed out again
+// to the next request with the same description, so passes of a frame and following frames
+// share a few targets instead of owning one each.
+class RenderTargetPool
+{
+public:
+    RenderTargetPool() = default;
+    RenderTargetPool(const RenderTargetPool& other) = delete;
+    RenderTargetPool(RenderTargetPool&& other) = delete;
+    ~RenderTargetPool();
+
+    RenderTargetPool& operator=(const RenderTargetPool& other) = delete;
+    RenderTargetPool& operator=(RenderTargetPool&& other) = delete;
+
+    // Returns nullptr if the framebuffer can't be completed.
+    RenderTarget* Acquire(const RenderTargetDesc& desc);
+    void          Release(RenderTarget* pTarget);
+
+    // Deletes the targets which aren't in use, e.g. after the viewport is resized.
+    void          Trim();
+    void          Clear();
+
+    size_t        GetTargetsCount() const { return m_targets.size(); }
+
+private:
+    static RenderTarget* CreateTarget(const RenderTargetDesc& desc);
+    static void          DeleteTarget(RenderTarget* pTarget);
+
+private:
+    std::vector<RenderTarget*> m_targets;
+};
+
+}
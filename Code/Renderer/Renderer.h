@@ -1,108 +1,60 @@
 #pragma once
 
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <functional>
 
-#include <string>
-#include <unordered_map>
+#include <glm/glm.hpp>
 
-#include "ShaderProgram.h"
+namespace VSUtils {
+struct CompressedTexture;
+}
 
 namespace VSEngine {
 class Scene;
 class Mesh;
-struct Texture;
-struct RenderData;
 
-enum class TextureType : char;
+// Writes width * height * channelsCount bytes of the image to pDestination, called on a worker thread.
+using TextureDecoder = std::function<bool(unsigned char* pDestination)>;
 
-class Renderer final
+// Rendering backend. Engine owns the single instance chosen in Engine::Initialize.
+class Renderer
 {
-private:
-    static void APIENTRY DebugCallback(GLenum source,
-                                       GLenum type,
-                                       GLuint id,
-                                       GLenum severity,
-                                       GLsizei length,
-                                       const GLchar* message,
-                                       GLvoid* userParam);
-
-    virtual void OnDebugMessage(GLenum source,
-                                GLenum type,
-                                GLuint id,
-                                GLenum severity,
-                                GLsizei length,
-                                const GLchar* message)
-    {}
-
 public:
-    Renderer();
-    Renderer(unsigned short viewportWidth, unsigned short viewportHeight);
-    ~Renderer();
-
-    void         ChangeViewportSize(unsigned short width, unsigned short height);
+    virtual ~Renderer() = default;
 
-    void         Render(double time, const Scene* scene, const glm::mat4& projMatrix);
-    void         RenderStart();
-    void         RenderFinish();
+    virtual void         ChangeViewportSize(unsigned short width, unsigned short height) = 0;
 
-    void         SetPostProcessShader(const char* szVertexShaderPath, const char* szFragmentShaderPath);
-    void         SetPostprocessKernel(const glm::mat3& kernel);
-    void         ClearPostprocessKernel();
-    void         ApplyPostprocess(bool shouldApply);
+    virtual void         Render(double time, const Scene* scene, const glm::mat4& projMatrix) = 0;
+    virtual void         RenderStart() = 0;
+    virtual void         RenderFinish() = 0;
 
-    size_t       GenerateMeshRenderData(const Mesh& mesh);
-    void         RemoveMeshRenderData(size_t renderDataId);
+    // Post effects are applied to the rendered scene in the order they are added.
+    // Scene is rendered straight to the screen while the chain is empty.
+    virtual void         AddPostprocessEffect(const char* szVertexShaderPath, const char* szFragmentShaderPath,
+                                              const glm::mat3& kernel) = 0;
+    // Convolution with a square kernel of odd size, weights are row major with the top row first.
+    // Separable kernels are applied as two 1D passes, the rest as a single compute pass.
+    virtual void         AddConvolutionEffect(const float* pWeights, size_t kernelSize) = 0;
+    virtual void         ClearPostprocessEffects() = 0;
 
-    void         SetShaderUniform(const char* name, bool value) const;
-    void         SetShaderUniform(const char* name, int value) const;
-    void         SetShaderUniform(const char* name, float value) const;
-    void         SetShaderUniform(const char* name, const glm::vec2& value) const;
-    void         SetShaderUniform(const char* name, float x, float y) const;
-    void         SetShaderUniform(const char* name, const glm::vec3& value) const;
-    void         SetShaderUniform(const char* name, float x, float y, float z) const;
-    void         SetShaderUniform(const char* name, const glm::vec4& value) const;
-    void         SetShaderUniform(const char* name, float x, float y, float z, float w) const;
-    void         SetShaderUniform(const char* name, const glm::mat2& mat) const;
-    void         SetShaderUniform(const char* name, const glm::mat3& mat) const;
-    void         SetShaderUniform(const char* name, const glm::mat4& mat) const;
+    virtual size_t       GenerateMeshRenderData(const Mesh& mesh) = 0;
+    virtual void         RemoveMeshRenderData(size_t renderDataId) = 0;
 
-    void         Reset();
+    virtual void         Reset() = 0;
 
-    void         ClearStoredObjects();
+    virtual void         ClearStoredObjects() = 0;
 
     // Generate texture render info.
-    unsigned int GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount);
-    void         DeleteTextureRenderInfo(unsigned int textureId);
-
-private:
-    void         Initialize();
-    void         RenderScene(const Scene* scene);
-    void         SetLightningUniforms(const Scene* scene);
-
-    void         InitializePostProcessData();
-    void         UninitializePostProcessData();
-public:
-    VSUtils::ShaderProgram programShader;
-    VSUtils::ShaderProgram lightShader;
-    VSUtils::ShaderProgram postProcessShader;
-
-private:
-    std::unordered_map<size_t, RenderData*> m_renderObjectsMap;
-
-    unsigned long                           m_renderDataIDCounter = 0;
-
-    // Post-process data
-    glm::mat3                               m_postprocessKernel;
-
-    GLuint                                  m_framebuffer = 0;;
-    GLuint                                  m_framebufferTexture = 0;
-    GLuint                                  m_renderbuffer = 0;
-
-    GLuint                                  m_screenQuadVAO = 0;
-    GLuint                                  m_screenQuadVBO = 0;
-
-    bool                                    m_applyPostprocessing = false;
+    virtual unsigned int GetTextureRenderInfo(const unsigned char* data, int width, int height, int channelsCount) = 0;
+    // Texture cooked with the complete mip chain, see Utils/DDSFile.h. Returns 0 if the format isn't supported.
+    virtual unsigned int GetCompressedTextureRenderInfo(const VSUtils::CompressedTexture& texture) = 0;
+    // Cooked texture which the renderer streams from the file by itself. Returns 0 if it isn't streamed,
+    // the texture should be loaded as a whole then.
+    virtual unsigned int GetStreamedTextureRenderInfo(const char* szCookedPath) = 0;
+    // Texture which is decoded and uploaded in the background, materials render without it meanwhile.
+    // Returns 0 if it can't be queued, the texture should be loaded synchronously then.
+    virtual unsigned int GetQueuedTextureRenderInfo(int width, int height, int channelsCount, TextureDecoder decoder) = 0;
+    virtual void         DeleteTextureRenderInfo(unsigned int textureId) = 0;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,136 @@
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace VSEngine {
+
+RingBuffer::~RingBuffer()
+{
+    Uninitialize();
+}
+
+void RingBuffer::Initialize(size_t regionSize)
+{
+    Reallocate(regionSize);
+}
+
+void RingBuffer::Uninitialize()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (m_buffer)
+    {
+        // Deleting the buffer unmaps it. GL keeps the storage alive while submitted commands read it.
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+
+    m_pData = nullptr;
+    m_regionSize = 0;
+    m_regionIndex = 0;
+    m_regionOffset = 0;
+}
+
+void RingBuffer::BeginFrame(size_t requiredSize)
+{
+    if (requiredSize > m_regionSize)
+    {
+        // New buffer doesn't share regions with the old one, nothing to wait for.
+        Reallocate(std::max(requiredSize, m_regionSize * 2));
+    }
+    else
+    {
+        m_regionIndex = (m_regionIndex + 1) % framesInFlightCount;
+        WaitForRegion(m_regionIndex);
+    }
+
+    m_regionOffset = 0;
+}
+
+void* RingBuffer::Allocate(size_t size, size_t alignment, GLintptr& offset)
+{
+    if (m_pData == nullptr)
+        return nullptr;
+
+    alignment = std::max<size_t>(alignment, 1);
+
+    // Regions start at multiples of their size, which is kept aligned in Reallocate.
+    const size_t regionBegin = m_regionIndex * m_regionSize;
+    const size_t alignedOffset = (regionBegin + m_regionOffset + alignment - 1) / alignment * alignment;
+    if (alignedOffset + size > regionBegin + m_regionSize)
+        return nullptr;
+
+    m_regionOffset = alignedOffset + size - regionBegin;
+    offset = static_cast<GLintptr>(alignedOffset);
+
+    return m_pData + alignedOffset;
+}
+
+void RingBuffer::EndFrame()
+{
+    GLsync& fence = m_fences[m_regionIndex];
+    if (fence)
+    {
+        glDeleteSync(fence);
+    }
+
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void RingBuffer::Reallocate(size_t regionSize)
+{
+    Uninitialize();
+
+    if (regionSize == 0)
+        return;
+
+    // Keeps region starts aligned for any GL offset alignment requirement.
+    constexpr size_t regionAlignment = 256;
+    regionSize = (regionSize + regionAlignment - 1) / regionAlignment * regionAlignment;
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = static_cast<GLsizeiptr>(regionSize * framesInFlightCount);
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+    m_pData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (m_pData == nullptr)
+    {
+        fprintf(stderr, "Failed to map ring buffer of %zu bytes.\n", static_cast<size_t>(size));
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        return;
+    }
+
+    m_regionSize = regionSize;
+}
+
+void RingBuffer::WaitForRegion(size_t regionIndex)
+{
+    GLsync& fence = m_fences[regionIndex];
+    if (fence == nullptr)
+        return;
+
+    constexpr GLuint64 waitTimeout = 1000000; // 1 ms
+    GLenum waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, waitTimeout);
+    while (waitResult == GL_TIMEOUT_EXPIRED)
+    {
+        waitResult = glClientWaitSync(fence, 0, waitTimeout);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+}
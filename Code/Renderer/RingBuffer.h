@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <array>
+#include <cstddef>
+
+namespace VSEngine {
+
+// Persistently mapped buffer split into framesInFlightCount regions, one per frame.
+// CPU writes the current frame region while GPU reads the previous ones. Every region is
+// fenced at the end of its frame, so the CPU waits only if the GPU is framesInFlightCount frames behind.
+// Can hold any per-frame data: instances, uniform blocks, storage blocks, indirect commands or vertices.
+class RingBuffer
+{
+public:
+    static constexpr size_t framesInFlightCount = 3;
+
+    RingBuffer() = default;
+    RingBuffer(const RingBuffer& other) = delete;
+    RingBuffer(RingBuffer&& other) = delete;
+    ~RingBuffer();
+
+    RingBuffer& operator=(const RingBuffer& other) = delete;
+    RingBuffer& operator=(RingBuffer&& other) = delete;
+
+    void        Initialize(size_t regionSize);
+    void        Uninitialize();
+
+    // Moves to the next region. Regions grow to requiredSize if it doesn't fit.
+    void        BeginFrame(size_t requiredSize);
+    // Suballocates from the current region. Returns nullptr if the region is full.
+    // Offset is from the beginning of the buffer.
+    void*       Allocate(size_t size, size_t alignment, GLintptr& offset);
+    // Called after the last GL command which reads the current region.
+    void        EndFrame();
+
+    GLuint      GetBuffer() const { return m_buffer; }
+
+private:
+    void        Reallocate(size_t regionSize);
+    void        WaitForRegion(size_t regionIndex);
+
+private:
+    GLuint                                   m_buffer = 0;
+    unsigned char*                           m_pData = nullptr;
+    size_t                                   m_regionSize = 0;
+
+    size_t                                   m_regionIndex = 0;
+    size_t                                   m_regionOffset = 0;
+
+    std::array<GLsync, framesInFlightCount>  m_fences = {};
+};
+
+}
@@ -1,59 +1,17 @@
 #include "Shader.h"
 
 #include <algorithm>
-#include <fstream>
-#include <sstream>
+#include <cstdio>
+#include <utility>
 
 namespace VSUtils {
-namespace {
-GLuint LoadShader(const char* name, GLenum type)
-{
-    // TODO: Remove hard-coded path
-    std::string path = std::string(ROOT_PATH) + "/Code/Shaders/" + name;
-    // ~TODO
-
-    std::replace(path.begin(), path.end(), '\\', '/');
-
-    std::ifstream file(path.c_str());
-
-    GLuint shader = glCreateShader(type);
-
-    if (!shader)
-        return 0;
-
-    std::stringstream fileStream;
-    fileStream << file.rdbuf();
-    std::string fileData = fileStream.str();
-    const char* rawFileData = fileData.c_str();
-
-    glShaderSource(shader, 1, &rawFileData, nullptr);
-
-    glCompileShader(shader);
-
-    GLint compileStatus{ 0 };
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
-
-    if (!compileStatus)
-    {
-        char buffer[4096];
-        glGetShaderInfoLog(shader, 4096, nullptr, buffer);
-
-        fprintf(stderr, "%s: %s\n", path.c_str(), buffer);
-
-        glDeleteShader(shader);
-
-        return 0;
-    }
-
-    return shader;
-}
-}
-
 Shader::Shader(const char* fname, GLuint shaderType) :
     fileName(fname),
     type(shaderType),
-    shader(LoadShader(fname, type))
-{}
+    shader(0)
+{
+    Compile();
+}
 
 Shader::~Shader()
 {
@@ -80,17 +38,91 @@ GLuint Shader::GetType() const
     return type;
 }
 
+bool Shader::LoadSource(const ShaderDefines& defines)
+{
+    // Compiled shader belongs to the previous source.
+    Delete();
+    sourceDefines = defines;
+
+    if (!PreprocessShader(fileName.c_str(), defines, source, sourceFiles))
+    {
+        source.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool Shader::DependsOn(const std::string& file) const
+{
+    return std::find(sourceFiles.begin(), sourceFiles.end(), file) != sourceFiles.end();
+}
+
 GLuint Shader::Compile()
 {
-    shader = LoadShader(fileName.c_str(), type);
+    return BeginCompile() ? FinishCompile() : 0;
+}
+
+bool Shader::BeginCompile()
+{
+    if (source.empty() && !LoadSource())
+        return false;
+
+    Delete();
+    shader = glCreateShader(type);
+
+    if (!shader)
+        return false;
+
+    const char* rawFileData = source.c_str();
+
+    glShaderSource(shader, 1, &rawFileData, nullptr);
+
+    glCompileShader(shader);
+
+    return true;
+}
+
+GLuint Shader::FinishCompile()
+{
+    if (shader == 0)
+        return 0;
+
+    GLint compileStatus{ 0 };
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+
+    if (!compileStatus)
+    {
+        char buffer[4096];
+        glGetShaderInfoLog(shader, 4096, nullptr, buffer);
+
+        fprintf(stderr, "%s: %s\n", GetShaderPath(sourceFiles[0].c_str()).c_str(), buffer);
+        // Messages refer to the files by their source string numbers.
+        for (size_t i = 1; i < sourceFiles.size(); ++i)
+        {
+            fprintf(stderr, "  %zu: %s\n", i, sourceFiles[i].c_str());
+        }
+
+        Delete();
+    }
 
     return shader;
 }
 
 GLuint Shader::RecompileShader()
 {
-    Delete();
-    return Compile();
+    const ShaderDefines defines = sourceDefines;
+    return LoadSource(defines) ? Compile() : 0;
+}
+
+void Shader::Swap(Shader& other)
+{
+    std::swap(fileName, other.fileName);
+    std::swap(source, other.source);
+    std::swap(sourceFiles, other.sourceFiles);
+    std::swap(sourceDefines, other.sourceDefines);
+    std::swap(type, other.type);
+    std::swap(shader, other.shader);
 }
 
 void Shader::Delete()
@@ -98,6 +130,7 @@ void Shader::Delete()
     if (shader != 0)
     {
         glDeleteShader(shader);
+        shader = 0;
     }
 }
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <GL/glew.h>
 
+#include "ShaderPreprocessor.h"
+
 namespace VSUtils {
 
 class Shader
@@ -15,17 +18,37 @@ public:
 
     void   ChangeFileName(const char* fname);
     void   ChangeType(GLuint shaderType);
+    const std::string& GetFileName() const { return fileName; }
+    const ShaderDefines& GetDefines() const { return sourceDefines; }
 
     GLuint GetID() const;
     GLuint GetType() const;
 
+    // Reads and preprocesses the source without compiling it, so it can be hashed before.
+    bool   LoadSource(const ShaderDefines& defines = ShaderDefines());
+    const std::string& GetSource() const { return source; }
+    // True if the file is the shader itself or one of its includes.
+    bool   DependsOn(const std::string& file) const;
+
+    // Loads the source first if it isn't loaded yet.
     GLuint Compile();
+    // Compile split in two: the first part only issues the compilation, so it can run in parallel
+    // with GL_KHR_parallel_shader_compile. Status is checked by FinishCompile, which returns 0 on failure.
+    bool   BeginCompile();
+    GLuint FinishCompile();
+    // Reloads the source with the same defines.
     GLuint RecompileShader();
 
     void   Delete();
+    // Exchanges everything including the GL object, copies would delete it twice.
+    void   Swap(Shader& other);
 
 private:
-    std::string fileName;
+    std::string              fileName;
+    std::string              source;
+    // Files of the source strings, see PreprocessShader.
+    std::vector<std::string> sourceFiles;
+    ShaderDefines            sourceDefines;
 
     GLuint type = 0;
     GLuint shader = 0;
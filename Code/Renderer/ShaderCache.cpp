@@ -0,0 +1,174 @@
+#include "ShaderCache.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "Shader.h"
+
+namespace VSUtils {
+namespace {
+// "VSPB", bumped version invalidates the files of the older layouts.
+constexpr uint32_t binaryMagic = 0x42505356u;
+constexpr uint32_t binaryVersion = 1;
+
+struct BinaryHeader
+{
+    uint32_t magic = binaryMagic;
+    uint32_t version = binaryVersion;
+    uint64_t key = 0;
+    uint32_t format = 0;
+    uint32_t length = 0;
+};
+
+// FNV-1a, 64 bit.
+constexpr uint64_t hashOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t hashPrime = 1099511628211ull;
+
+uint64_t HashBytes(uint64_t hash, const void* pData, size_t size)
+{
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ pBytes[i]) * hashPrime;
+    }
+
+    return hash;
+}
+
+uint64_t HashString(uint64_t hash, const std::string& value)
+{
+    // Length separates the strings, so "ab" + "c" and "a" + "bc" differ.
+    const uint64_t length = value.size();
+    hash = HashBytes(hash, &length, sizeof(length));
+
+    return HashBytes(hash, value.data(), value.size());
+}
+
+std::string GetGLString(GLenum name)
+{
+    const GLubyte* pValue = glGetString(name);
+
+    return pValue ? reinterpret_cast<const char*>(pValue) : "";
+}
+}
+
+void ShaderCache::Initialize(const std::string& directory)
+{
+    m_directory = directory;
+    m_loadedCount = 0;
+    m_missedCount = 0;
+
+    GLint formatsCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatsCount);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    m_isEnabled = formatsCount > 0 && !error;
+    if (!m_isEnabled)
+    {
+        fprintf(stderr, "Shader cache is disabled: %s\n",
+                formatsCount > 0 ? error.message().c_str() : "program binaries aren't supported");
+        return;
+    }
+
+    m_driver = GetGLString(GL_VENDOR) + "|" + GetGLString(GL_RENDERER) + "|" + GetGLString(GL_VERSION) + "|" +
+               GetGLString(GL_SHADING_LANGUAGE_VERSION);
+}
+
+uint64_t ShaderCache::CalculateKey(const Shader* const* pStages, size_t stagesCount) const
+{
+    uint64_t hash = HashString(hashOffsetBasis, m_driver);
+    for (size_t i = 0; i < stagesCount; ++i)
+    {
+        const GLuint type = pStages[i]->GetType();
+        hash = HashBytes(hash, &type, sizeof(type));
+        hash = HashString(hash, pStages[i]->GetSource());
+    }
+
+    return hash;
+}
+
+GLuint ShaderCache::LoadProgram(uint64_t key)
+{
+    if (!m_isEnabled)
+        return 0;
+
+    std::ifstream file(GetFilePath(key), std::ios::binary);
+
+    BinaryHeader header;
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        header.magic == binaryMagic && header.version == binaryVersion && header.key == key && header.length > 0)
+    {
+        binary.resize(header.length);
+        file.read(binary.data(), header.length);
+    }
+
+    if (binary.empty() || !file)
+    {
+        ++m_missedCount;
+        return 0;
+    }
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // Driver rejects binaries of the other builds even if the strings match.
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (!status)
+    {
+        glDeleteProgram(program);
+        ++m_missedCount;
+        return 0;
+    }
+
+    ++m_loadedCount;
+
+    return program;
+}
+
+void ShaderCache::StoreProgram(uint64_t key, GLuint program) const
+{
+    if (!m_isEnabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    BinaryHeader header;
+    header.key = key;
+
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLsizei writtenLength = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &writtenLength, &format, binary.data());
+    header.format = format;
+    header.length = static_cast<uint32_t>(writtenLength);
+
+    const std::string path = GetFilePath(key);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), writtenLength);
+
+    if (!file)
+    {
+        fprintf(stderr, "Shader cache: %s can't be written\n", path.c_str());
+    }
+}
+
+std::string ShaderCache::GetFilePath(uint64_t key) const
+{
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "%016" PRIx64 ".bin", key);
+
+    return m_directory + "/" + fileName;
+}
+
+}
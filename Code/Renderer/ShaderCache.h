@@ -0,0 +1,50 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace VSUtils {
+class Shader;
+
+// Linked program binaries persisted between launches, so programs are loaded with
+// glProgramBinary instead of being compiled on every start.
+// Binaries are keyed by the driver, types and sources of the stages. Defines end up in the sources,
+// so every variant gets its own binary. An edited shader or updated driver changes the key, and a binary
+// which is rejected by the driver falls back to the compilation, so stale files are harmless.
+class ShaderCache
+{
+public:
+    // Cache stays disabled if the driver doesn't support any binary format.
+    void     Initialize(const std::string& directory);
+    bool     IsEnabled() const { return m_isEnabled; }
+
+    // Sources of the stages should be loaded.
+    uint64_t CalculateKey(const Shader* const* pStages, size_t stagesCount) const;
+
+    // Returns linked program or 0 if there is no valid binary for the key.
+    GLuint   LoadProgram(uint64_t key);
+    // Program should be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+    void     StoreProgram(uint64_t key, GLuint program) const;
+
+    size_t   GetLoadedCount() const { return m_loadedCount.load(); }
+    size_t   GetMissedCount() const { return m_missedCount.load(); }
+
+private:
+    std::string GetFilePath(uint64_t key) const;
+
+private:
+    std::string         m_directory;
+    // Vendor, renderer and version strings.
+    std::string         m_driver;
+    bool                m_isEnabled = false;
+
+    // Programs can be compiled by the worker thread of ShaderCompiler.
+    std::atomic<size_t> m_loadedCount{ 0 };
+    std::atomic<size_t> m_missedCount{ 0 };
+};
+
+}
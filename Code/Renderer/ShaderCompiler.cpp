@@ -0,0 +1,168 @@
+#include "ShaderCompiler.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cstdio>
+
+#include "ShaderCache.h"
+#include "ShaderProgram.h"
+
+namespace VSUtils {
+ShaderCompiler::~ShaderCompiler()
+{
+    Uninitialize();
+}
+
+void ShaderCompiler::Initialize(GLFWwindow* pMainWindow)
+{
+    Uninitialize();
+
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        // Let the driver pick the number of its threads.
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        m_mode = Mode::ParallelExtension;
+        return;
+    }
+
+    if (pMainWindow == nullptr)
+        return;
+
+    // Hints of the main window are still set, the worker context gets the same version and profile.
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    m_pWorkerWindow = glfwCreateWindow(1, 1, "", nullptr, pMainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (m_pWorkerWindow == nullptr)
+    {
+        fprintf(stderr, "Shader compiler: worker context isn't created, shaders are compiled serially\n");
+        return;
+    }
+
+    m_isStopping = false;
+    m_mode = Mode::WorkerContext;
+    m_worker = std::thread(&ShaderCompiler::WorkerLoop, this);
+}
+
+void ShaderCompiler::Uninitialize()
+{
+    if (m_worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isStopping = true;
+        }
+
+        m_requestCondition.notify_all();
+        m_worker.join();
+    }
+
+    if (m_pWorkerWindow)
+    {
+        glfwDestroyWindow(m_pWorkerWindow);
+        m_pWorkerWindow = nullptr;
+    }
+
+    m_requests.clear();
+    m_completedPrograms.clear();
+    m_mode = Mode::Serial;
+}
+
+void ShaderCompiler::Compile(ShaderProgram* pProgram, ShaderCache* pCache)
+{
+    switch (m_mode)
+    {
+    case Mode::ParallelExtension:
+        pProgram->BeginCompileProgram(pCache);
+        break;
+    case Mode::WorkerContext:
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back({ pProgram, pCache });
+        }
+        m_requestCondition.notify_one();
+        break;
+    default:
+        pProgram->CompileProgram(pCache);
+        break;
+    }
+}
+
+bool ShaderCompiler::IsCompleted(ShaderProgram* pProgram)
+{
+    switch (m_mode)
+    {
+    case Mode::ParallelExtension:
+        if (!pProgram->IsCompileCompleted())
+            return false;
+
+        pProgram->FinishCompileProgram();
+        return true;
+    case Mode::WorkerContext:
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_completedPrograms.erase(pProgram) != 0;
+        }
+    default:
+        return true;
+    }
+}
+
+void ShaderCompiler::Wait(ShaderProgram* pProgram)
+{
+    switch (m_mode)
+    {
+    case Mode::ParallelExtension:
+        pProgram->FinishCompileProgram();
+        break;
+    case Mode::WorkerContext:
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_completionCondition.wait(lock, [this, pProgram]()
+            {
+                return m_completedPrograms.count(pProgram) != 0;
+            });
+            m_completedPrograms.erase(pProgram);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void ShaderCompiler::WorkerLoop()
+{
+    glfwMakeContextCurrent(m_pWorkerWindow);
+
+    while (true)
+    {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_requestCondition.wait(lock, [this]()
+            {
+                return m_isStopping || !m_requests.empty();
+            });
+
+            if (m_isStopping)
+                break;
+
+            request = m_requests.front();
+            m_requests.pop_front();
+        }
+
+        request.pProgram->CompileProgram(request.pCache);
+        // Objects of a shared context are complete for the other contexts only after the commands are finished.
+        glFinish();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completedPrograms.insert(request.pProgram);
+        }
+        m_completionCondition.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+}
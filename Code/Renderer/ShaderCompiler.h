@@ -0,0 +1,74 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+struct GLFWwindow;
+
+namespace VSUtils {
+class ShaderCache;
+class ShaderProgram;
+
+// Compiles programs without blocking the render thread.
+// With GL_KHR_parallel_shader_compile the driver compiles on its own threads and completion is polled.
+// Otherwise programs are compiled by a worker thread with a hidden context sharing objects with the main one.
+// If that context can't be created, programs are compiled right away, as before.
+class ShaderCompiler
+{
+public:
+    enum class Mode : char
+    {
+        Serial,
+        ParallelExtension,
+        WorkerContext
+    };
+
+    ShaderCompiler() = default;
+    ShaderCompiler(const ShaderCompiler& other) = delete;
+    ShaderCompiler(ShaderCompiler&& other) = delete;
+    ~ShaderCompiler();
+
+    ShaderCompiler& operator=(const ShaderCompiler& other) = delete;
+    ShaderCompiler& operator=(ShaderCompiler&& other) = delete;
+
+    // Called on the thread of the main context, the worker context is shared with the window's one.
+    void Initialize(GLFWwindow* pMainWindow);
+    void Uninitialize();
+
+    Mode GetMode() const { return m_mode; }
+
+    // Program shouldn't be touched until IsCompleted returns true for it. Cache is optional.
+    void Compile(ShaderProgram* pProgram, ShaderCache* pCache);
+    // Doesn't block. Once it returns true, GetProgram() of the program is the linked program or 0 on failure.
+    bool IsCompleted(ShaderProgram* pProgram);
+    // Blocks until the program is completed, e.g. before it's deleted.
+    void Wait(ShaderProgram* pProgram);
+
+private:
+    struct Request
+    {
+        ShaderProgram* pProgram = nullptr;
+        ShaderCache*   pCache = nullptr;
+    };
+
+    void WorkerLoop();
+
+private:
+    Mode                               m_mode = Mode::Serial;
+
+    GLFWwindow*                        m_pWorkerWindow = nullptr;
+    std::thread                        m_worker;
+    std::mutex                         m_mutex;
+    std::condition_variable            m_requestCondition;
+    std::condition_variable            m_completionCondition;
+    std::deque<Request>                m_requests;
+    std::unordered_set<ShaderProgram*> m_completedPrograms;
+    bool                               m_isStopping = false;
+};
+
+}
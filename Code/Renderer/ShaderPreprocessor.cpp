@@ -0,0 +1,148 @@
+#include "ShaderPreprocessor.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace VSUtils {
+namespace {
+constexpr size_t maxIncludeDepth = 16;
+
+bool ReadFile(const std::string& path, std::string& contents)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        fprintf(stderr, "%s: can't be opened\n", path.c_str());
+        return false;
+    }
+
+    std::stringstream fileStream;
+    fileStream << file.rdbuf();
+    contents = fileStream.str();
+
+    return true;
+}
+
+bool IsDirective(const std::string& line, const char* directive, size_t& end)
+{
+    const size_t begin = line.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return false;
+
+    const std::string::size_type length = std::char_traits<char>::length(directive);
+    if (line.compare(begin, length, directive) != 0)
+        return false;
+
+    end = begin + length;
+    return true;
+}
+
+// Returns false for the lines which aren't #include "name".
+bool ParseInclude(const std::string& line, std::string& includeName)
+{
+    size_t end = 0;
+    if (!IsDirective(line, "#include", end))
+        return false;
+
+    const size_t open = line.find('"', end);
+    const size_t close = (open == std::string::npos) ? std::string::npos : line.find('"', open + 1);
+    if (close == std::string::npos)
+        return false;
+
+    includeName = line.substr(open + 1, close - open - 1);
+    return true;
+}
+
+void AppendLineDirective(size_t lineNumber, size_t fileIndex, std::string& source)
+{
+    source += "#line " + std::to_string(lineNumber) + " " + std::to_string(fileIndex) + "\n";
+}
+
+void AppendDefines(const ShaderDefines& defines, std::string& source)
+{
+    for (const std::string& define : defines)
+    {
+        source += "#define " + define + "\n";
+    }
+}
+
+bool AppendFile(const std::string& name, size_t depth, const ShaderDefines& defines,
+                std::string& source, std::vector<std::string>& files)
+{
+    const size_t fileIndex = files.size();
+    files.push_back(name);
+
+    std::string contents;
+    if (!ReadFile(GetShaderPath(name.c_str()), contents))
+        return false;
+
+    if (depth > 0)
+    {
+        AppendLineDirective(1, fileIndex, source);
+    }
+
+    std::istringstream stream(contents);
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(stream, line))
+    {
+        ++lineNumber;
+
+        std::string includeName;
+        if (ParseInclude(line, includeName))
+        {
+            if (depth + 1 >= maxIncludeDepth)
+            {
+                fprintf(stderr, "%s:%zu: includes are nested too deep\n", name.c_str(), lineNumber);
+                return false;
+            }
+
+            // Skipping the included files also breaks include cycles.
+            if (std::find(files.begin(), files.end(), includeName) == files.end())
+            {
+                if (!AppendFile(includeName, depth + 1, defines, source, files))
+                    return false;
+
+                AppendLineDirective(lineNumber + 1, fileIndex, source);
+            }
+            continue;
+        }
+
+        source += line;
+        source += '\n';
+
+        size_t directiveEnd = 0;
+        if (depth == 0 && !defines.empty() && IsDirective(line, "#version", directiveEnd))
+        {
+            AppendDefines(defines, source);
+            AppendLineDirective(lineNumber + 1, fileIndex, source);
+        }
+    }
+
+    return true;
+}
+}
+
+std::string GetShaderPath(const char* name)
+{
+    // TODO: Remove hard-coded path
+    std::string path = std::string(ROOT_PATH) + "/Code/Shaders/" + name;
+    // ~TODO
+
+    std::replace(path.begin(), path.end(), '\\', '/');
+
+    return path;
+}
+
+bool PreprocessShader(const char* name, const ShaderDefines& defines,
+                      std::string& source, std::vector<std::string>& files)
+{
+    source.clear();
+    files.clear();
+
+    return AppendFile(name, 0, defines, source, files);
+}
+
+}
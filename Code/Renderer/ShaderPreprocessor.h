@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace VSUtils {
+
+// "NAME" or "NAME VALUE" each, injected as #define.
+using ShaderDefines = std::vector<std::string>;
+
+// Full path of the shader named relative to Code/Shaders.
+std::string GetShaderPath(const char* name);
+
+// Resolves #include "name" directives, names are relative to Code/Shaders like the shader names.
+// Every file is included once, the following includes of it are dropped. Defines are injected
+// right after #version. #line directives keep compiler messages pointing to the lines of the
+// original files: source string number of a line is the index of its file in files, 0 is the shader.
+bool PreprocessShader(const char* name, const ShaderDefines& defines,
+                      std::string& source, std::vector<std::string>& files);
+
+}
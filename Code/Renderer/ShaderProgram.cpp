@@ -1,7 +1,10 @@
 #include "ShaderProgram.h"
 
+#include <utility>
 #include <vector>
 
+#include "ShaderCache.h"
+
 namespace VSUtils {
 ShaderProgram::ShaderProgram(const char* vertexPath,
                              const char* fragmentPath) :
@@ -18,45 +21,248 @@ void ShaderProgram::SetVertexShader(const char* vertexPath)
 {
     m_vertexShader.ChangeFileName(vertexPath);
     m_vertexShader.ChangeType(GL_VERTEX_SHADER);
-    m_vertexShader.Compile();
+    m_vertexShader.LoadSource(m_defines);
 }
 
 void ShaderProgram::SetFragmentShader(const char* fragmentPath)
 {
     m_fragmentShader.ChangeFileName(fragmentPath);
     m_fragmentShader.ChangeType(GL_FRAGMENT_SHADER);
-    m_fragmentShader.Compile();
+    m_fragmentShader.LoadSource(m_defines);
 }
 
-GLuint ShaderProgram::CompileProgram()
+void ShaderProgram::SetComputeShader(const char* computePath)
+{
+    m_computeShader.ChangeFileName(computePath);
+    m_computeShader.ChangeType(GL_COMPUTE_SHADER);
+    m_computeShader.LoadSource(m_defines);
+}
+
+GLuint ShaderProgram::CompileProgram(ShaderCache* pCache)
+{
+    BeginCompileProgram(pCache);
+
+    return FinishCompileProgram();
+}
+
+void ShaderProgram::BeginCompileProgram(ShaderCache* pCache)
 {
     if (m_program != 0)
     {
         glDeleteProgram(m_program);
+        m_program = 0;
+    }
+
+    m_pCompileCache = (pCache && pCache->IsEnabled()) ? pCache : nullptr;
+    m_compileCacheKey = 0;
+    m_isCompiling = false;
+
+    Shader* stages[maxStagesCount] = {};
+    const size_t stagesCount = GetStages(stages);
+
+    if (m_pCompileCache)
+    {
+        m_compileCacheKey = m_pCompileCache->CalculateKey(stages, stagesCount);
+        m_program = m_pCompileCache->LoadProgram(m_compileCacheKey);
+        if (m_program != 0)
+        {
+            ReflectUniforms();
+            return;
+        }
+    }
+
+    // Stages are compiled only if the program isn't in the cache.
+    for (size_t i = 0; i < stagesCount; ++i)
+    {
+        if (stages[i]->GetID() == 0 && !stages[i]->BeginCompile())
+            return;
     }
 
     m_program = glCreateProgram();
 
-    glAttachShader(m_program, m_vertexShader.GetID());
-    glAttachShader(m_program, m_fragmentShader.GetID());
+    if (m_pCompileCache)
+    {
+        glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    for (size_t i = 0; i < stagesCount; ++i)
+    {
+        glAttachShader(m_program, stages[i]->GetID());
+    }
 
+    // Link is issued right away, the driver waits for the stages itself.
     glLinkProgram(m_program);
+    m_isCompiling = true;
+}
+
+bool ShaderProgram::IsCompileCompleted() const
+{
+    if (!m_isCompiling)
+        return true;
+
+    GLint isCompleted = GL_FALSE;
+    glGetProgramiv(m_program, GL_COMPLETION_STATUS_KHR, &isCompleted);
+
+    return isCompleted == GL_TRUE;
+}
+
+GLuint ShaderProgram::FinishCompileProgram()
+{
+    if (!m_isCompiling)
+        return m_program;
+
+    m_isCompiling = false;
+
+    Shader* stages[maxStagesCount] = {};
+    const size_t stagesCount = GetStages(stages);
+
+    bool areStagesCompiled = true;
+    for (size_t i = 0; i < stagesCount; ++i)
+    {
+        // Every stage reports its errors.
+        areStagesCompiled = stages[i]->FinishCompile() != 0 && areStagesCompiled;
+    }
 
     GLint status{ 0 };
-    glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    if (areStagesCompiled)
+    {
+        glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+    }
 
     if (!status)
     {
-        char buffer[4096];
-        glGetProgramInfoLog(m_program, 4096, nullptr, buffer);
+        if (areStagesCompiled)
+        {
+            char buffer[4096];
+            glGetProgramInfoLog(m_program, 4096, nullptr, buffer);
+
+            fprintf(stderr, "program: %s\n", buffer);
+        }
 
-        fprintf(stderr, "program: %s\n", buffer);
+        glDeleteProgram(m_program);
+        m_program = 0;
         return 0;
     }
 
+    if (m_pCompileCache)
+    {
+        m_pCompileCache->StoreProgram(m_compileCacheKey, m_program);
+    }
+
+    ReflectUniforms();
+
     return m_program;
 }
 
+size_t ShaderProgram::GetStages(Shader* (&stages)[maxStagesCount])
+{
+    if (!m_computeShader.GetSource().empty())
+    {
+        stages[0] = &m_computeShader;
+        return 1;
+    }
+
+    stages[0] = &m_vertexShader;
+    stages[1] = &m_fragmentShader;
+    return 2;
+}
+
+bool ShaderProgram::DependsOn(const std::string& file) const
+{
+    return m_vertexShader.DependsOn(file) || m_fragmentShader.DependsOn(file) || m_computeShader.DependsOn(file);
+}
+
+ShaderProgram* ShaderProgram::CreateReloadCopy() const
+{
+    ShaderProgram* pCopy = new ShaderProgram();
+    pCopy->SetDefines(m_defines);
+
+    if (!m_computeShader.GetSource().empty())
+    {
+        pCopy->SetComputeShader(m_computeShader.GetFileName().c_str());
+    }
+    else
+    {
+        pCopy->SetVertexShader(m_vertexShader.GetFileName().c_str());
+        pCopy->SetFragmentShader(m_fragmentShader.GetFileName().c_str());
+    }
+
+    return pCopy;
+}
+
+void ShaderProgram::Swap(ShaderProgram& other)
+{
+    m_vertexShader.Swap(other.m_vertexShader);
+    m_fragmentShader.Swap(other.m_fragmentShader);
+    m_computeShader.Swap(other.m_computeShader);
+    std::swap(m_defines, other.m_defines);
+    std::swap(m_program, other.m_program);
+    std::swap(m_pCompileCache, other.m_pCompileCache);
+    std::swap(m_compileCacheKey, other.m_compileCacheKey);
+    std::swap(m_isCompiling, other.m_isCompiling);
+    std::swap(m_uniformLocations, other.m_uniformLocations);
+}
+
+void ShaderProgram::ReflectUniforms()
+{
+    m_uniformLocations.clear();
+
+    GLint uniformsCount = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniformsCount);
+
+    GLint maxNameLength = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(static_cast<size_t>(maxNameLength) + 1);
+    for (GLint i = 0; i < uniformsCount; ++i)
+    {
+        GLsizei nameLength = 0;
+        GLint arraySize = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_program, static_cast<GLuint>(i), maxNameLength, &nameLength,
+                           &arraySize, &type, nameBuffer.data());
+
+        const GLint location = glGetUniformLocation(m_program, nameBuffer.data());
+        // Uniforms of uniform blocks have no location.
+        if (location < 0)
+            continue;
+
+        std::string name(nameBuffer.data(), static_cast<size_t>(nameLength));
+        AddUniformLocation(name, location);
+
+        // Arrays are reported as "name[0]". Register "name" and every element as well.
+        const size_t arraySuffix = name.rfind("[0]");
+        if (arraySuffix == std::string::npos || arraySuffix + 3 != name.size())
+            continue;
+
+        const std::string baseName = name.substr(0, arraySuffix);
+        AddUniformLocation(baseName, location);
+
+        for (GLint element = 1; element < arraySize; ++element)
+        {
+            const std::string elementName = baseName + "[" + std::to_string(element) + "]";
+            AddUniformLocation(elementName, location + element);
+        }
+    }
+}
+
+void ShaderProgram::AddUniformLocation(const std::string& name, GLint location)
+{
+    m_uniformLocations.emplace(HashUniformName(name.c_str()), UniformLocation{ name, location });
+}
+
+GLint ShaderProgram::GetUniformLocation(const char* name) const
+{
+    const auto range = m_uniformLocations.equal_range(HashUniformName(name));
+    for (auto locationIt = range.first; locationIt != range.second; ++locationIt)
+    {
+        if (locationIt->second.name == name)
+            return locationIt->second.location;
+    }
+
+    return -1;
+}
+
 bool ShaderProgram::UseProgram() const
 {
     if (m_program)
@@ -70,82 +276,157 @@ bool ShaderProgram::UseProgram() const
 
 void ShaderProgram::SetBool(const char* name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(m_program, name), static_cast<int>(value));
+    SetBool(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetInt(const char* name, int value) const
 {
-    glUniform1i(glGetUniformLocation(m_program, name), value);
+    SetInt(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetFloat(const char* name, float value) const
 {
-    glUniform1f(glGetUniformLocation(m_program, name), value);
+    SetFloat(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetBoolN(const char* name, const bool* pValue, size_t count) const
 {
-    std::vector<int> boolAsInt(count);
-    for (size_t i = 0; i < count; ++i)
-    {
-        boolAsInt[i] = static_cast<int>(pValue[i]);
-    }
-    glUniform1iv(glGetUniformLocation(m_program, name), count, boolAsInt.data());
+    SetBoolN(GetUniformLocation(name), pValue, count);
 }
 
 void ShaderProgram::SetIntN(const char* name, const int* pValue, size_t count) const
 {
-    glUniform1iv(glGetUniformLocation(m_program, name), count, pValue);
+    SetIntN(GetUniformLocation(name), pValue, count);
 }
 
 void ShaderProgram::SetFloatN(const char* name, const float* pValue, size_t count) const
 {
-    glUniform1fv(glGetUniformLocation(m_program, name), count, pValue);
+    SetFloatN(GetUniformLocation(name), pValue, count);
 }
 
 void ShaderProgram::SetVec2(const char* name, const glm::vec2& value) const
 {
-    glUniform2fv(glGetUniformLocation(m_program, name), 1, &value[0]);
+    SetVec2(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetVec2(const char* name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(m_program, name), x, y);
+    SetVec2(GetUniformLocation(name), x, y);
 }
 
 void ShaderProgram::SetVec3(const char* name, const glm::vec3& value) const
 {
-    glUniform3fv(glGetUniformLocation(m_program, name), 1, &value[0]);
+    SetVec3(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetVec3(const char* name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(m_program, name), x, y, z);
+    SetVec3(GetUniformLocation(name), x, y, z);
 }
 
 void ShaderProgram::SetVec4(const char* name, const glm::vec4& value) const
 {
-    glUniform4fv(glGetUniformLocation(m_program, name), 1, &value[0]);
+    SetVec4(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetVec4(const char* name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(m_program, name), x, y, z, w);
+    SetVec4(GetUniformLocation(name), x, y, z, w);
 }
 
 void ShaderProgram::SetMat2(const char* name, const glm::mat2& mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(m_program, name), 1, GL_FALSE, &mat[0][0]);
+    SetMat2(GetUniformLocation(name), mat);
 }
 
 void ShaderProgram::SetMat3(const char* name, const glm::mat3& mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(m_program, name), 1, GL_FALSE, &mat[0][0]);
+    SetMat3(GetUniformLocation(name), mat);
 }
 
 void ShaderProgram::SetMat4(const char* name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(m_program, name), 1, GL_FALSE, &mat[0][0]);
+    SetMat4(GetUniformLocation(name), mat);
+}
+
+void ShaderProgram::SetBool(GLint location, bool value) const
+{
+    glProgramUniform1i(m_program, location, static_cast<int>(value));
+}
+
+void ShaderProgram::SetInt(GLint location, int value) const
+{
+    glProgramUniform1i(m_program, location, value);
+}
+
+void ShaderProgram::SetFloat(GLint location, float value) const
+{
+    glProgramUniform1f(m_program, location, value);
+}
+
+void ShaderProgram::SetBoolN(GLint location, const bool* pValue, size_t count) const
+{
+    std::vector<int> boolAsInt(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        boolAsInt[i] = static_cast<int>(pValue[i]);
+    }
+    glProgramUniform1iv(m_program, location, count, boolAsInt.data());
+}
+
+void ShaderProgram::SetIntN(GLint location, const int* pValue, size_t count) const
+{
+    glProgramUniform1iv(m_program, location, count, pValue);
+}
+
+void ShaderProgram::SetFloatN(GLint location, const float* pValue, size_t count) const
+{
+    glProgramUniform1fv(m_program, location, count, pValue);
+}
+
+void ShaderProgram::SetVec2(GLint location, const glm::vec2& value) const
+{
+    glProgramUniform2fv(m_program, location, 1, &value[0]);
+}
+
+void ShaderProgram::SetVec2(GLint location, float x, float y) const
+{
+    glProgramUniform2f(m_program, location, x, y);
+}
+
+void ShaderProgram::SetVec3(GLint location, const glm::vec3& value) const
+{
+    glProgramUniform3fv(m_program, location, 1, &value[0]);
+}
+
+void ShaderProgram::SetVec3(GLint location, float x, float y, float z) const
+{
+    glProgramUniform3f(m_program, location, x, y, z);
+}
+
+void ShaderProgram::SetVec4(GLint location, const glm::vec4& value) const
+{
+    glProgramUniform4fv(m_program, location, 1, &value[0]);
+}
+
+void ShaderProgram::SetVec4(GLint location, float x, float y, float z, float w) const
+{
+    glProgramUniform4f(m_program, location, x, y, z, w);
+}
+
+void ShaderProgram::SetMat2(GLint location, const glm::mat2& mat) const
+{
+    glProgramUniformMatrix2fv(m_program, location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void ShaderProgram::SetMat3(GLint location, const glm::mat3& mat) const
+{
+    glProgramUniformMatrix3fv(m_program, location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void ShaderProgram::SetMat4(GLint location, const glm::mat4& mat) const
+{
+    glProgramUniformMatrix4fv(m_program, location, 1, GL_FALSE, &mat[0][0]);
 }
 
 }
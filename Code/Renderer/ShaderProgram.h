@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <GL/glew.h>
 
 #include <glm/glm.hpp>
@@ -8,6 +11,20 @@
 #include "Shader.h"
 
 namespace VSUtils {
+class ShaderCache;
+
+// FNV-1a hash of uniform name. Uniform locations are stored by this hash,
+// so lookups by name don't allocate strings. Names are compared as well, hashes may collide.
+constexpr unsigned int HashUniformName(const char* name)
+{
+    unsigned int hash = 2166136261u;
+    for (; *name != '\0'; ++name)
+    {
+        hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+    }
+
+    return hash;
+}
 
 class ShaderProgram
 {
@@ -17,13 +34,38 @@ public:
                   const char* fragmentPath);
     ~ShaderProgram();
 
+    // Defines are applied to the stages set after the call.
+    void SetDefines(const ShaderDefines& defines) { m_defines = defines; }
+
     void SetVertexShader(const char* vertexPath);
     void SetFragmentShader(const char* fragmentPath);
+    // Program with compute shader has no other stages.
+    void SetComputeShader(const char* computePath);
 
-    GLuint CompileProgram();
+    // Program is loaded from the cache if it has a binary of the same sources, and stored to it otherwise.
+    GLuint CompileProgram(ShaderCache* pCache = nullptr);
+
+    // CompileProgram split in parts for GL_KHR_parallel_shader_compile. Begin only issues the work,
+    // IsCompileCompleted polls it without blocking (requires the extension), Finish checks the results
+    // and returns the same as CompileProgram. Program shouldn't be used in between.
+    void   BeginCompileProgram(ShaderCache* pCache = nullptr);
+    bool   IsCompileCompleted() const;
+    GLuint FinishCompileProgram();
+
+    // True if any stage is built from the file, see Shader::DependsOn.
+    bool DependsOn(const std::string& file) const;
+    // Not compiled program with the same stages and defines. Sources are read again.
+    ShaderProgram* CreateReloadCopy() const;
+    // Exchanges the programs, pointers to both stay valid. Neither should be compiling.
+    void Swap(ShaderProgram& other);
 
     bool UseProgram() const;
+    GLuint GetProgram() const { return m_program; }
 
+    // Location from the table filled at link time. -1 if uniform isn't active.
+    GLint GetUniformLocation(const char* name) const;
+
+    // Setters write to this program, it doesn't have to be in use.
     void SetBool(const char* name, bool value) const;
     void SetInt(const char* name, int value) const;
     void SetFloat(const char* name, float value) const;
@@ -39,11 +81,54 @@ public:
     void SetMat2(const char* name, const glm::mat2& mat) const;
     void SetMat3(const char* name, const glm::mat3& mat) const;
     void SetMat4(const char* name, const glm::mat4& mat) const;
+
+    // Same setters by location, for the uniforms which are set every draw.
+    void SetBool(GLint location, bool value) const;
+    void SetInt(GLint location, int value) const;
+    void SetFloat(GLint location, float value) const;
+    void SetBoolN(GLint location, const bool* pValue, size_t count) const;
+    void SetIntN(GLint location, const int* pValue, size_t count) const;
+    void SetFloatN(GLint location, const float* pValue, size_t count) const;
+    void SetVec2(GLint location, const glm::vec2& value) const;
+    void SetVec2(GLint location, float x, float y) const;
+    void SetVec3(GLint location, const glm::vec3& value) const;
+    void SetVec3(GLint location, float x, float y, float z) const;
+    void SetVec4(GLint location, const glm::vec4& value) const;
+    void SetVec4(GLint location, float x, float y, float z, float w) const;
+    void SetMat2(GLint location, const glm::mat2& mat) const;
+    void SetMat3(GLint location, const glm::mat3& mat) const;
+    void SetMat4(GLint location, const glm::mat4& mat) const;
+
+private:
+    static constexpr size_t maxStagesCount = 2;
+
+    // Enumerates active uniforms of linked program into the location table.
+    void ReflectUniforms();
+    void AddUniformLocation(const std::string& name, GLint location);
+    size_t GetStages(Shader* (&stages)[maxStagesCount]);
+
 private:
     Shader m_vertexShader;
     Shader m_fragmentShader;
+    Shader m_computeShader;
+
+    ShaderDefines m_defines;
 
     GLuint m_program = 0;
+
+    // State of the compilation between BeginCompileProgram and FinishCompileProgram.
+    ShaderCache* m_pCompileCache = nullptr;
+    uint64_t m_compileCacheKey = 0;
+    bool m_isCompiling = false;
+
+    struct UniformLocation
+    {
+        std::string name;
+        GLint       location = -1;
+    };
+
+    // Entries with the same hash are told apart by their names.
+    std::unordered_multimap<unsigned int, UniformLocation> m_uniformLocations;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "ShaderReloader.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "ShaderCompiler.h"
+#include "ShaderProgram.h"
+
+namespace VSUtils {
+ShaderReloader::~ShaderReloader()
+{
+    Uninitialize();
+}
+
+void ShaderReloader::Initialize(ShaderCache* pCache, ShaderCompiler* pCompiler)
+{
+    Uninitialize();
+
+    m_pCache = pCache;
+    m_pCompiler = pCompiler;
+}
+
+void ShaderReloader::Uninitialize()
+{
+    for (const PendingReload& reload : m_reloads)
+    {
+        DiscardCopy(reload.pCopy);
+    }
+
+    m_reloads.clear();
+    m_pCache = nullptr;
+    m_pCompiler = nullptr;
+}
+
+void ShaderReloader::Reload(ShaderProgram* pProgram)
+{
+    Cancel(pProgram);
+
+    ShaderProgram* pCopy = pProgram->CreateReloadCopy();
+    if (m_pCompiler)
+    {
+        m_pCompiler->Compile(pCopy, m_pCache);
+    }
+    else
+    {
+        pCopy->CompileProgram(m_pCache);
+    }
+
+    m_reloads.push_back({ pProgram, pCopy });
+}
+
+void ShaderReloader::Cancel(ShaderProgram* pProgram)
+{
+    const auto reloadIter = std::find_if(m_reloads.begin(), m_reloads.end(), [pProgram](const PendingReload& reload)
+    {
+        return reload.pProgram == pProgram;
+    });
+
+    if (reloadIter != m_reloads.end())
+    {
+        DiscardCopy(reloadIter->pCopy);
+        m_reloads.erase(reloadIter);
+    }
+}
+
+void ShaderReloader::Update(std::vector<ShaderProgram*>& reloadedPrograms)
+{
+    auto pendingEnd = std::stable_partition(m_reloads.begin(), m_reloads.end(), [this](const PendingReload& reload)
+    {
+        return m_pCompiler && !m_pCompiler->IsCompleted(reload.pCopy);
+    });
+
+    for (auto reloadIter = pendingEnd; reloadIter != m_reloads.end(); ++reloadIter)
+    {
+        ShaderProgram* pProgram = reloadIter->pProgram;
+        ShaderProgram* pCopy = reloadIter->pCopy;
+
+        if (pCopy->GetProgram() == 0)
+        {
+            fprintf(stderr, "Shader reload failed, the previous program is kept\n");
+        }
+        else
+        {
+            // The copy takes the old GL program and deletes it.
+            pProgram->Swap(*pCopy);
+            reloadedPrograms.push_back(pProgram);
+        }
+
+        delete pCopy;
+    }
+
+    m_reloads.erase(pendingEnd, m_reloads.end());
+}
+
+void ShaderReloader::DiscardCopy(ShaderProgram* pCopy)
+{
+    if (m_pCompiler)
+    {
+        m_pCompiler->Wait(pCopy);
+    }
+
+    delete pCopy;
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+
+namespace VSUtils {
+class ShaderCache;
+class ShaderCompiler;
+class ShaderProgram;
+
+// Recompiles programs from their changed sources without stalling the frame.
+// A reloaded copy is compiled by the compiler in the background; once it's linked it's swapped
+// with the program in Update, between draws, so the users keep their pointers. If the copy doesn't
+// compile the program is kept as it was and the error is printed.
+class ShaderReloader
+{
+public:
+    ShaderReloader() = default;
+    ShaderReloader(const ShaderReloader& other) = delete;
+    ShaderReloader(ShaderReloader&& other) = delete;
+    ~ShaderReloader();
+
+    ShaderReloader& operator=(const ShaderReloader& other) = delete;
+    ShaderReloader& operator=(ShaderReloader&& other) = delete;
+
+    // Cache and compiler are optional, without compiler the copies are compiled right away.
+    void Initialize(ShaderCache* pCache, ShaderCompiler* pCompiler);
+    // Waits for the pending copies.
+    void Uninitialize();
+
+    // Program should be compiled. Reloading it again before it's swapped restarts the reload.
+    void Reload(ShaderProgram* pProgram);
+    // Should be called before the program is deleted.
+    void Cancel(ShaderProgram* pProgram);
+
+    // Swaps the completed copies in. Appends the programs which were replaced,
+    // their GL programs and uniform locations are new.
+    void Update(std::vector<ShaderProgram*>& reloadedPrograms);
+
+    bool IsReloading() const { return !m_reloads.empty(); }
+
+private:
+    struct PendingReload
+    {
+        ShaderProgram* pProgram = nullptr;
+        ShaderProgram* pCopy = nullptr;
+    };
+
+    // Waits for the copy and deletes it.
+    void DiscardCopy(ShaderProgram* pCopy);
+
+private:
+    ShaderCache*               m_pCache = nullptr;
+    ShaderCompiler*            m_pCompiler = nullptr;
+    std::vector<PendingReload> m_reloads;
+};
+
+}
@@ -0,0 +1,121 @@
+#include "ShaderVariants.h"
+
+#include <cstdio>
+
+#include "ShaderCompiler.h"
+
+namespace VSUtils {
+ShaderVariants::~ShaderVariants()
+{
+    Clear();
+}
+
+void ShaderVariants::Initialize(const char* vertexPath, const char* fragmentPath,
+                                const std::vector<std::string>& flagDefines, const ShaderDefines& commonDefines,
+                                ShaderCache* pCache, ShaderCompiler* pCompiler)
+{
+    Clear();
+
+    m_vertexPath = vertexPath;
+    m_fragmentPath = fragmentPath;
+    m_flagDefines = flagDefines;
+    m_commonDefines = commonDefines;
+    m_pCache = pCache;
+    m_pCompiler = pCompiler;
+}
+
+void ShaderVariants::Clear()
+{
+    for (auto& variant : m_variants)
+    {
+        // Compiler still owns the pending programs.
+        if (variant.second.isPending && m_pCompiler)
+        {
+            m_pCompiler->Wait(variant.second.pProgram);
+        }
+
+        delete variant.second.pProgram;
+    }
+
+    m_variants.clear();
+}
+
+void ShaderVariants::RetryFailedVariants()
+{
+    for (auto variantIter = m_variants.begin(); variantIter != m_variants.end();)
+    {
+        if (variantIter->second.pProgram == nullptr)
+        {
+            variantIter = m_variants.erase(variantIter);
+        }
+        else
+        {
+            ++variantIter;
+        }
+    }
+}
+
+ShaderProgram* ShaderVariants::GetVariant(uint32_t key)
+{
+    auto variantIter = m_variants.find(key);
+    if (variantIter == m_variants.end())
+    {
+        variantIter = m_variants.emplace(key, Variant{ CreateVariant(key), true }).first;
+    }
+
+    Variant& variant = variantIter->second;
+    if (variant.isPending)
+    {
+        // Without compiler the variant is compiled by CreateVariant already.
+        if (m_pCompiler && !m_pCompiler->IsCompleted(variant.pProgram))
+            return nullptr;
+
+        variant.isPending = false;
+        OnCompiled(key, variant);
+    }
+
+    return variant.pProgram;
+}
+
+ShaderProgram* ShaderVariants::CreateVariant(uint32_t key)
+{
+    ShaderDefines defines = m_commonDefines;
+    for (size_t bit = 0; bit < m_flagDefines.size(); ++bit)
+    {
+        if (key & (1u << bit))
+        {
+            defines.push_back(m_flagDefines[bit]);
+        }
+    }
+
+    ShaderProgram* pProgram = new ShaderProgram();
+    pProgram->SetDefines(defines);
+    pProgram->SetVertexShader(m_vertexPath.c_str());
+    pProgram->SetFragmentShader(m_fragmentPath.c_str());
+
+    if (m_pCompiler)
+    {
+        m_pCompiler->Compile(pProgram, m_pCache);
+    }
+    else
+    {
+        pProgram->CompileProgram(m_pCache);
+    }
+
+    return pProgram;
+}
+
+void ShaderVariants::OnCompiled(uint32_t key, Variant& variant)
+{
+    if (variant.pProgram->GetProgram() == 0)
+    {
+        fprintf(stderr, "%s: variant 0x%x isn't compiled\n", m_fragmentPath.c_str(), key);
+        delete variant.pProgram;
+        variant.pProgram = nullptr;
+        return;
+    }
+
+    ++m_compiledCount;
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ShaderProgram.h"
+
+namespace VSUtils {
+class ShaderCache;
+class ShaderCompiler;
+
+// Permutations of a vertex and fragment shader pair. Every bit of the permutation key enables
+// one define, so a variant compiles only the features it needs. Variants are compiled on the
+// first request and kept by their keys; binaries of the cache make the following launches cheap.
+// With a compiler the first requests don't wait: they get nullptr until the variant is ready.
+class ShaderVariants
+{
+public:
+    ShaderVariants() = default;
+    ShaderVariants(const ShaderVariants& other) = delete;
+    ShaderVariants(ShaderVariants&& other) = delete;
+    ~ShaderVariants();
+
+    ShaderVariants& operator=(const ShaderVariants& other) = delete;
+    ShaderVariants& operator=(ShaderVariants&& other) = delete;
+
+    // Define of bit i of the key is flagDefines[i], common defines are added to every variant.
+    // Cache and compiler are optional.
+    void           Initialize(const char* vertexPath, const char* fragmentPath,
+                              const std::vector<std::string>& flagDefines, const ShaderDefines& commonDefines,
+                              ShaderCache* pCache, ShaderCompiler* pCompiler);
+    // Waits for the pending variants.
+    void           Clear();
+
+    // Returns nullptr while the variant is compiled and if it doesn't compile.
+    // Failed variants aren't compiled again until Clear.
+    ShaderProgram* GetVariant(uint32_t key);
+    // Grows every time a variant becomes ready.
+    size_t         GetCompiledCount() const { return m_compiledCount; }
+
+    // Failed variants are compiled again on the next request, e.g. after their sources are fixed.
+    void           RetryFailedVariants();
+
+    template<typename Function>
+    void           ForEachVariant(const Function& function) const
+    {
+        for (const auto& variant : m_variants)
+        {
+            if (variant.second.pProgram && !variant.second.isPending)
+            {
+                function(*variant.second.pProgram);
+            }
+        }
+    }
+
+    template<typename Function>
+    void           ForEachVariant(const Function& function)
+    {
+        for (auto& variant : m_variants)
+        {
+            if (variant.second.pProgram && !variant.second.isPending)
+            {
+                function(*variant.second.pProgram);
+            }
+        }
+    }
+
+private:
+    struct Variant
+    {
+        ShaderProgram* pProgram = nullptr;
+        bool           isPending = false;
+    };
+
+    ShaderProgram* CreateVariant(uint32_t key);
+    // Deletes the program if it failed.
+    void           OnCompiled(uint32_t key, Variant& variant);
+
+private:
+    std::string                                  m_vertexPath;
+    std::string                                  m_fragmentPath;
+    std::vector<std::string>                     m_flagDefines;
+    ShaderDefines                                m_commonDefines;
+    ShaderCache*                                 m_pCache = nullptr;
+    ShaderCompiler*                              m_pCompiler = nullptr;
+
+    std::unordered_map<uint32_t, Variant>        m_variants;
+    size_t                                       m_compiledCount = 0;
+};
+
+}
@@ -0,0 +1,212 @@
+#include "ShaderWatcher.h"
+
+#include <cstdio>
+#include <system_error>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace VSUtils {
+namespace {
+constexpr auto scanInterval = std::chrono::milliseconds(500);
+
+bool IsShaderFile(const std::filesystem::path& path)
+{
+    return path.extension() == ".glsl";
+}
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    Uninitialize();
+}
+
+void ShaderWatcher::Initialize(const char* directory)
+{
+    Uninitialize();
+
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error))
+    {
+        fprintf(stderr, "Shader directory %s can't be watched\n", directory);
+        return;
+    }
+
+    // Without the trailing separator, so relative names don't start with "..".
+    m_directory = std::filesystem::path(directory).lexically_normal();
+    if (!m_directory.has_filename())
+    {
+        m_directory = m_directory.parent_path();
+    }
+
+#ifdef __linux__
+    m_notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_notifyHandle >= 0 && AddWatches(m_directory))
+    {
+        printf("Watching shaders with inotify\n");
+        return;
+    }
+
+    fprintf(stderr, "inotify isn't available, shader files are polled\n");
+    if (m_notifyHandle >= 0)
+    {
+        close(m_notifyHandle);
+        m_notifyHandle = -1;
+    }
+    m_watchedDirectories.clear();
+#endif
+
+    // First scan only records the times.
+    std::vector<std::string> changedFiles;
+    ScanFiles(changedFiles);
+}
+
+void ShaderWatcher::Uninitialize()
+{
+#ifdef __linux__
+    if (m_notifyHandle >= 0)
+    {
+        close(m_notifyHandle);
+        m_notifyHandle = -1;
+    }
+#endif
+
+    m_watchedDirectories.clear();
+    m_fileTimes.clear();
+    m_directory.clear();
+}
+
+void ShaderWatcher::Poll(std::vector<std::string>& changedFiles)
+{
+    if (!IsEnabled())
+        return;
+
+    if (m_notifyHandle >= 0)
+    {
+        ReadEvents(changedFiles);
+    }
+    else if (std::chrono::steady_clock::now() - m_lastScanTime >= scanInterval)
+    {
+        ScanFiles(changedFiles);
+    }
+}
+
+bool ShaderWatcher::AddWatches(const std::filesystem::path& directory)
+{
+#ifdef __linux__
+    // Editors often save by writing a temporary file and renaming it over the original.
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+    const int watch = inotify_add_watch(m_notifyHandle, directory.c_str(), mask);
+    if (watch < 0)
+        return false;
+
+    m_watchedDirectories[watch] = directory;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, error))
+    {
+        if (entry.is_directory(error))
+        {
+            const int subdirectoryWatch = inotify_add_watch(m_notifyHandle, entry.path().c_str(), mask);
+            if (subdirectoryWatch < 0)
+                return false;
+
+            m_watchedDirectories[subdirectoryWatch] = entry.path();
+        }
+    }
+
+    return true;
+#else
+    (void)directory;
+    return false;
+#endif
+}
+
+void ShaderWatcher::ReadEvents(std::vector<std::string>& changedFiles)
+{
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+
+    for (;;)
+    {
+        const ssize_t length = read(m_notifyHandle, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            if (length < 0 && errno != EAGAIN && errno != EINTR)
+            {
+                fprintf(stderr, "Reading inotify events failed, errno %d\n", errno);
+            }
+            return;
+        }
+
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + pEvent->len;
+
+            const auto directoryIt = m_watchedDirectories.find(pEvent->wd);
+            if (directoryIt == m_watchedDirectories.end() || pEvent->len == 0)
+                continue;
+
+            const std::filesystem::path path = directoryIt->second / pEvent->name;
+            if (pEvent->mask & IN_ISDIR)
+            {
+                if (pEvent->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    AddWatches(path);
+                }
+            }
+            else if ((pEvent->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && IsShaderFile(path))
+            {
+                changedFiles.push_back(GetRelativeName(path));
+            }
+        }
+    }
+#else
+    (void)changedFiles;
+#endif
+}
+
+void ShaderWatcher::ScanFiles(std::vector<std::string>& changedFiles)
+{
+    m_lastScanTime = std::chrono::steady_clock::now();
+
+    const bool isFirstScan = m_fileTimes.empty();
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(m_directory, error))
+    {
+        if (!entry.is_regular_file(error) || !IsShaderFile(entry.path()))
+            continue;
+
+        const FileTime time = entry.last_write_time(error);
+        if (error)
+            continue;
+
+        std::string name = GetRelativeName(entry.path());
+        auto timeIt = m_fileTimes.find(name);
+        if (timeIt == m_fileTimes.end())
+        {
+            if (!isFirstScan)
+            {
+                changedFiles.push_back(name);
+            }
+            m_fileTimes.emplace(std::move(name), time);
+        }
+        else if (timeIt->second != time)
+        {
+            timeIt->second = time;
+            changedFiles.push_back(std::move(name));
+        }
+    }
+}
+
+std::string ShaderWatcher::GetRelativeName(const std::filesystem::path& path) const
+{
+    return path.lexically_relative(m_directory).generic_string();
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VSUtils {
+
+// Reports shader files which were written since the previous poll.
+// On Linux the directory tree is watched with inotify, elsewhere (or if inotify isn't available)
+// modification times of the files are compared a couple of times per second.
+class ShaderWatcher
+{
+public:
+    ShaderWatcher() = default;
+    ShaderWatcher(const ShaderWatcher& other) = delete;
+    ShaderWatcher(ShaderWatcher&& other) = delete;
+    ~ShaderWatcher();
+
+    ShaderWatcher& operator=(const ShaderWatcher& other) = delete;
+    ShaderWatcher& operator=(ShaderWatcher&& other) = delete;
+
+    void Initialize(const char* directory);
+    void Uninitialize();
+
+    bool IsEnabled() const { return !m_directory.empty(); }
+
+    // Doesn't block. Appends the names relative to the directory, as passed to Shader, e.g. "Include/Lights.glsl".
+    void Poll(std::vector<std::string>& changedFiles);
+
+private:
+    using FileTime = std::filesystem::file_time_type;
+
+    bool AddWatches(const std::filesystem::path& directory);
+    void ReadEvents(std::vector<std::string>& changedFiles);
+    void ScanFiles(std::vector<std::string>& changedFiles);
+    std::string GetRelativeName(const std::filesystem::path& path) const;
+
+private:
+    std::filesystem::path                          m_directory;
+
+    // inotify descriptor and the directories of its watches.
+    int                                            m_notifyHandle = -1;
+    std::unordered_map<int, std::filesystem::path> m_watchedDirectories;
+
+    // Polling fallback.
+    std::unordered_map<std::string, FileTime>      m_fileTimes;
+    std::chrono::steady_clock::time_point          m_lastScanTime;
+};
+
+}
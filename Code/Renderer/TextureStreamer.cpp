@@ -0,0 +1,315 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "MaterialTextures.h"
+#include "Utils/DDSFile.h"
+
+namespace VSEngine {
+namespace {
+int GetMipmapLevelsCount(int width, int height)
+{
+    int levelsCount = 1;
+    for (int size = std::max(width, height); size > 1; size /= 2)
+    {
+        ++levelsCount;
+    }
+
+    return levelsCount;
+}
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    Uninitialize();
+}
+
+void TextureStreamer::Initialize(MaterialTextures* pTextures, System::JobSystem* pJobSystem)
+{
+    m_pTextures = pTextures;
+    m_pJobSystem = pJobSystem;
+}
+
+void TextureStreamer::Uninitialize()
+{
+    for (PendingLoad* pLoad : m_pendingLoads)
+    {
+        if (m_pJobSystem)
+        {
+            m_pJobSystem->Wait(pLoad->counter);
+        }
+
+        auto textureIt = m_textures.find(pLoad->textureId);
+        if (textureIt != m_textures.end())
+        {
+            textureIt->second.isLoading = false;
+            m_residentSize -= GetLevelSize(textureIt->second, pLoad->level);
+        }
+
+        delete pLoad;
+    }
+
+    m_pendingLoads.clear();
+}
+
+GLuint TextureStreamer::AddTexture(const char* szPath)
+{
+    if (m_pTextures == nullptr)
+        return 0;
+
+    VSUtils::DDSDescription description;
+    if (!VSUtils::ReadDDSDescription(szPath, description))
+        return 0;
+
+    StreamedTexture texture;
+    texture.path = szPath;
+    texture.format = description.format;
+    texture.width = description.width;
+    texture.height = description.height;
+    texture.levelsCount = static_cast<int>(description.levelsCount);
+
+    // Any level of the complete chain can be the base one.
+    if (texture.levelsCount != GetMipmapLevelsCount(texture.width, texture.height))
+        return 0;
+
+    while (texture.baseLevel + 1 < texture.levelsCount &&
+           std::max(texture.width >> texture.baseLevel, texture.height >> texture.baseLevel) > residentBaseSize)
+    {
+        ++texture.baseLevel;
+    }
+
+    texture.residentLevel = texture.baseLevel;
+    texture.requestedLevel = texture.baseLevel;
+
+    VSUtils::CompressedTexture baseLevels;
+    if (!VSUtils::LoadDDSLevels(szPath, texture.baseLevel, SIZE_MAX, baseLevels))
+        return 0;
+
+    const GLuint textureId = m_pTextures->AddCompressedTexture(baseLevels);
+    if (textureId == 0)
+        return 0;
+
+    for (int level = texture.baseLevel; level < texture.levelsCount; ++level)
+    {
+        m_residentSize += GetLevelSize(texture, level);
+    }
+
+    m_textures[textureId] = std::move(texture);
+
+    return textureId;
+}
+
+void TextureStreamer::RemoveTexture(GLuint textureId)
+{
+    auto textureIt = m_textures.find(textureId);
+    if (textureIt == m_textures.end())
+        return;
+
+    const StreamedTexture& texture = textureIt->second;
+    for (int level = texture.residentLevel; level < texture.levelsCount; ++level)
+    {
+        m_residentSize -= GetLevelSize(texture, level);
+    }
+
+    // Id can be given to another texture before the load is finished.
+    for (PendingLoad* pLoad : m_pendingLoads)
+    {
+        if (pLoad->textureId == textureId)
+        {
+            m_residentSize -= GetLevelSize(texture, pLoad->level);
+            pLoad->textureId = 0;
+        }
+    }
+
+    m_textures.erase(textureIt);
+}
+
+void TextureStreamer::RequestLevels(GLuint textureId, float screenSize)
+{
+    auto textureIt = m_textures.find(textureId);
+    if (textureIt == m_textures.end())
+        return;
+
+    StreamedTexture& texture = textureIt->second;
+
+    // Texture is assumed to be mapped over the object once, a texel per pixel is enough.
+    const float texelsPerPixel = static_cast<float>(std::max(texture.width, texture.height)) / std::max(screenSize, 1.0f);
+    const int level = texelsPerPixel > 1.0f ? std::min(static_cast<int>(std::log2(texelsPerPixel)), texture.baseLevel) : 0;
+
+    if (texture.lastUsedFrame != m_frameIndex)
+    {
+        texture.lastUsedFrame = m_frameIndex;
+        texture.requestedLevel = level;
+    }
+    else
+    {
+        texture.requestedLevel = std::min(texture.requestedLevel, level);
+    }
+}
+
+void TextureStreamer::Update()
+{
+    FinishLoads();
+
+    // Budget could be lowered meanwhile.
+    if (m_budget != 0 && m_residentSize > m_budget)
+    {
+        FreeBudget(0);
+    }
+
+    StartLoads();
+
+    ++m_frameIndex;
+}
+
+void TextureStreamer::FinishLoads()
+{
+    for (size_t i = 0; i < m_pendingLoads.size();)
+    {
+        PendingLoad* pLoad = m_pendingLoads[i];
+        if (!pLoad->counter.IsDone())
+        {
+            ++i;
+            continue;
+        }
+
+        auto textureIt = m_textures.find(pLoad->textureId);
+        if (textureIt != m_textures.end())
+        {
+            StreamedTexture& texture = textureIt->second;
+            texture.isLoading = false;
+
+            if (pLoad->isLoaded && m_pTextures->AddTopLevels(pLoad->textureId, pLoad->texture.levels))
+            {
+                texture.residentLevel = pLoad->level;
+            }
+            else
+            {
+                // E.g. all the texture arrays are taken by other sizes. Larger levels won't fit either.
+                texture.failedLevel = pLoad->level;
+                m_residentSize -= GetLevelSize(texture, pLoad->level);
+            }
+        }
+
+        delete pLoad;
+        m_pendingLoads[i] = m_pendingLoads.back();
+        m_pendingLoads.pop_back();
+    }
+}
+
+void TextureStreamer::StartLoads()
+{
+    m_candidates.clear();
+    for (const auto& texturePair : m_textures)
+    {
+        const StreamedTexture& texture = texturePair.second;
+        if (texture.lastUsedFrame == m_frameIndex && !texture.isLoading &&
+            texture.requestedLevel < texture.residentLevel && texture.residentLevel - 1 > texture.failedLevel)
+        {
+            m_candidates.push_back(texturePair.first);
+        }
+    }
+
+    // Textures missing the most levels go first.
+    std::sort(m_candidates.begin(), m_candidates.end(), [this](GLuint lhs, GLuint rhs)
+    {
+        const StreamedTexture& lhsTexture = m_textures.at(lhs);
+        const StreamedTexture& rhsTexture = m_textures.at(rhs);
+        return lhsTexture.residentLevel - lhsTexture.requestedLevel > rhsTexture.residentLevel - rhsTexture.requestedLevel;
+    });
+
+    for (GLuint textureId : m_candidates)
+    {
+        if (m_pendingLoads.size() >= maxPendingLoadsCount)
+            break;
+
+        StreamedTexture& texture = m_textures.at(textureId);
+
+        // Levels are streamed one by one, every upload makes the texture sharper.
+        const int level = texture.residentLevel - 1;
+        const size_t levelSize = GetLevelSize(texture, level);
+        if (m_budget != 0 && m_residentSize + levelSize > m_budget && !FreeBudget(levelSize))
+            break;
+
+        // Level is accounted as resident from now on, so loads in flight don't exceed the budget together.
+        m_residentSize += levelSize;
+        texture.isLoading = true;
+
+        PendingLoad* pLoad = new PendingLoad();
+        pLoad->textureId = textureId;
+        pLoad->path = texture.path;
+        pLoad->level = level;
+        m_pendingLoads.push_back(pLoad);
+
+        auto loadLevel = [pLoad]()
+        {
+            pLoad->isLoaded = VSUtils::LoadDDSLevels(pLoad->path.c_str(), static_cast<size_t>(pLoad->level), 1,
+                                                     pLoad->texture);
+        };
+
+        if (m_pJobSystem)
+        {
+            m_pJobSystem->ScheduleBackground(loadLevel, pLoad->counter);
+        }
+        else
+        {
+            loadLevel();
+        }
+    }
+}
+
+bool TextureStreamer::FreeBudget(size_t size)
+{
+    // Textures in loading keep their levels: the loaded level has to continue the resident chain.
+    m_evictable.clear();
+    for (const auto& texturePair : m_textures)
+    {
+        const StreamedTexture& texture = texturePair.second;
+        const int lowestLevel = texture.lastUsedFrame == m_frameIndex ? texture.requestedLevel : texture.baseLevel;
+        if (!texture.isLoading && texture.residentLevel < lowestLevel)
+        {
+            m_evictable.push_back(texturePair.first);
+        }
+    }
+
+    // Least recently used first.
+    std::sort(m_evictable.begin(), m_evictable.end(), [this](GLuint lhs, GLuint rhs)
+    {
+        return m_textures.at(lhs).lastUsedFrame < m_textures.at(rhs).lastUsedFrame;
+    });
+
+    for (GLuint textureId : m_evictable)
+    {
+        if (m_residentSize + size <= m_budget)
+            break;
+
+        StreamedTexture& texture = m_textures.at(textureId);
+        const int lowestLevel = texture.lastUsedFrame == m_frameIndex ? texture.requestedLevel : texture.baseLevel;
+
+        // Levels of a texture are dropped at once, the texture is reallocated once.
+        size_t freedSize = 0;
+        int residentLevel = texture.residentLevel;
+        while (residentLevel < lowestLevel && m_residentSize - freedSize + size > m_budget)
+        {
+            freedSize += GetLevelSize(texture, residentLevel);
+            ++residentLevel;
+        }
+
+        if (m_pTextures->DropTopLevels(textureId, residentLevel - texture.residentLevel))
+        {
+            texture.residentLevel = residentLevel;
+            m_residentSize -= freedSize;
+        }
+    }
+
+    return m_residentSize + size <= m_budget;
+}
+
+size_t TextureStreamer::GetLevelSize(const StreamedTexture& texture, int level)
+{
+    return VSUtils::GetLevelSize(texture.format, std::max(texture.width >> level, 1), std::max(texture.height >> level, 1));
+}
+
+}
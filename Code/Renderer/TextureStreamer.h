@@ -0,0 +1,115 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/System/JobSystem.h"
+#include "Utils/TextureCompression.h"
+
+namespace VSEngine {
+class MaterialTextures;
+
+// Streams the mip levels of cooked textures (see Utils/DDSFile.h) in and out of MaterialTextures.
+// Textures are loaded with the levels up to residentBaseSize only. Larger levels are requested by the visible
+// objects from their size on screen, read from the file by jobs and uploaded a level at a time by Update.
+// Resident levels are kept within the budget by dropping the top levels of the least recently used textures.
+class TextureStreamer
+{
+public:
+    // Largest base level of a texture which isn't streamed in yet.
+    static constexpr int    residentBaseSize = 64;
+    // Loads in flight, each of them holds its level until Update uploads it.
+    static constexpr size_t maxPendingLoadsCount = 8;
+
+    TextureStreamer() = default;
+    TextureStreamer(const TextureStreamer& other) = delete;
+    TextureStreamer(TextureStreamer&& other) = delete;
+    ~TextureStreamer();
+
+    TextureStreamer& operator=(const TextureStreamer& other) = delete;
+    TextureStreamer& operator=(TextureStreamer&& other) = delete;
+
+    // Levels are loaded synchronously without job system.
+    void       Initialize(MaterialTextures* pTextures, System::JobSystem* pJobSystem);
+    // Waits for the loads in flight, resident levels stay.
+    void       Uninitialize();
+
+    // Bytes of the resident levels of the streamed textures. Zero budget means unlimited.
+    void       SetBudget(size_t budget) { m_budget = budget; }
+    size_t     GetBudget() const { return m_budget; }
+    size_t     GetResidentSize() const { return m_residentSize; }
+
+    // Returns the id of the texture in MaterialTextures, 0 if the file can't be streamed.
+    GLuint     AddTexture(const char* szPath);
+    // Forgets the texture, MaterialTextures still owns it.
+    void       RemoveTexture(GLuint textureId);
+
+    // Visible object with the texture covers screenSize pixels. Requests of a frame are handled by the next Update.
+    void       RequestLevels(GLuint textureId, float screenSize);
+
+    // Uploads the finished loads and starts the loads of the requested levels, freeing the budget for them.
+    // Binds textures behind the state cache.
+    void       Update();
+
+private:
+    struct StreamedTexture
+    {
+        std::string          path;
+        VSUtils::BlockFormat format = VSUtils::BlockFormat::BC1;
+        // Level 0.
+        int                  width = 0;
+        int                  height = 0;
+        int                  levelsCount = 0;
+        // Levels below baseLevel are streamed, the ones above residentLevel are in memory.
+        int                  baseLevel = 0;
+        int                  residentLevel = 0;
+        // Smallest level which couldn't be loaded, levels up to it aren't tried again.
+        int                  failedLevel = -1;
+        // Level the visible objects needed at lastUsedFrame.
+        int                  requestedLevel = 0;
+        uint64_t             lastUsedFrame = 0;
+        bool                 isLoading = false;
+    };
+
+    struct PendingLoad
+    {
+        GLuint                     textureId = 0;
+        std::string                path;
+        int                        level = 0;
+        VSUtils::CompressedTexture texture;
+        bool                       isLoaded = false;
+        System::JobCounter         counter;
+    };
+
+    void       FinishLoads();
+    void       StartLoads();
+    // Drops top levels until size more bytes fit into the budget. Textures used by the last frame
+    // keep the levels they requested. Returns false if the budget can't be freed.
+    bool       FreeBudget(size_t size);
+
+    static size_t GetLevelSize(const StreamedTexture& texture, int level);
+
+private:
+    MaterialTextures*                           m_pTextures = nullptr;
+    System::JobSystem*                          m_pJobSystem = nullptr;
+
+    std::unordered_map<GLuint, StreamedTexture> m_textures;
+    std::vector<PendingLoad*>                   m_pendingLoads;
+
+    size_t                                      m_budget = 0;
+    size_t                                      m_residentSize = 0;
+
+    // Requests are stamped with it, Update moves it on.
+    uint64_t                                    m_frameIndex = 1;
+
+    // Kept between updates to avoid reallocations.
+    std::vector<GLuint>                         m_candidates;
+    std::vector<GLuint>                         m_evictable;
+};
+
+}
@@ -0,0 +1,280 @@
+#include "TextureUploadQueue.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "MaterialTextures.h"
+
+namespace VSEngine {
+namespace {
+// Uploads of a frame are issued until it's spent, at least one is issued anyway.
+constexpr auto uploadTimeBudget = std::chrono::microseconds(2000);
+// Keeps staging offsets aligned for any GL offset alignment requirement.
+constexpr size_t stagingAlignment = 256;
+
+size_t AlignStaging(size_t offset)
+{
+    return (offset + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+}
+}
+
+TextureUploadQueue::~TextureUploadQueue()
+{
+    Uninitialize();
+}
+
+void TextureUploadQueue::Initialize(MaterialTextures* pTextures, System::JobSystem* pJobSystem)
+{
+    Uninitialize();
+
+    m_pTextures = pTextures;
+    m_pJobSystem = pJobSystem;
+
+    constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    constexpr GLsizeiptr size = static_cast<GLsizeiptr>(stagingBufferSize);
+
+    glGenBuffers(1, &m_stagingBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_stagingBuffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+    m_pStagingData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (m_pStagingData == nullptr)
+    {
+        fprintf(stderr, "Failed to map texture staging buffer of %zu bytes.\n", stagingBufferSize);
+        glDeleteBuffers(1, &m_stagingBuffer);
+        m_stagingBuffer = 0;
+    }
+}
+
+void TextureUploadQueue::Uninitialize()
+{
+    for (QueuedUpload* pUpload : m_uploads)
+    {
+        if (pUpload->isStaged && m_pJobSystem)
+        {
+            m_pJobSystem->Wait(pUpload->counter);
+        }
+
+        if (pUpload->fence)
+        {
+            glDeleteSync(pUpload->fence);
+        }
+
+        delete pUpload;
+    }
+
+    m_uploads.clear();
+    m_stagedCount = 0;
+
+    if (m_stagingBuffer)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_stagingBuffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &m_stagingBuffer);
+        m_stagingBuffer = 0;
+    }
+
+    m_pStagingData = nullptr;
+}
+
+GLuint TextureUploadQueue::QueueTexture(int width, int height, int channelsCount, TextureDecoder decoder)
+{
+    if (m_pStagingData == nullptr || m_pTextures == nullptr || !decoder || width <= 0 || height <= 0)
+        return 0;
+
+    const size_t size = static_cast<size_t>(width) * height * channelsCount;
+    if (size == 0 || size > stagingBufferSize)
+        return 0;
+
+    const GLuint textureId = m_pTextures->ReserveTexture(width, height, channelsCount);
+    if (textureId == 0)
+        return 0;
+
+    QueuedUpload* pUpload = new QueuedUpload();
+    pUpload->textureId = textureId;
+    pUpload->size = size;
+    pUpload->decoder = std::move(decoder);
+    m_uploads.push_back(pUpload);
+
+    // Textures queued while a scene loads are decoded meanwhile, not from the first frame.
+    StartDecoding();
+
+    return textureId;
+}
+
+void TextureUploadQueue::CancelTexture(GLuint textureId)
+{
+    if (textureId == 0)
+        return;
+
+    for (size_t i = 0; i < m_uploads.size(); ++i)
+    {
+        QueuedUpload* pUpload = m_uploads[i];
+        if (pUpload->textureId != textureId)
+            continue;
+
+        // Staged upload holds its memory until it's retired in order, the job may still write to it.
+        if (pUpload->isStaged)
+        {
+            pUpload->textureId = 0;
+        }
+        else
+        {
+            delete pUpload;
+            m_uploads.erase(m_uploads.begin() + i);
+        }
+
+        return;
+    }
+}
+
+void TextureUploadQueue::Update()
+{
+    RetireUploads();
+    IssueUploads();
+    StartDecoding();
+}
+
+void TextureUploadQueue::RetireUploads()
+{
+    while (m_stagedCount > 0)
+    {
+        QueuedUpload* pUpload = m_uploads.front();
+        if (!pUpload->isUploaded)
+            break;
+
+        if (pUpload->fence)
+        {
+            if (glClientWaitSync(pUpload->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+                break;
+
+            glDeleteSync(pUpload->fence);
+        }
+
+        delete pUpload;
+        m_uploads.pop_front();
+        --m_stagedCount;
+    }
+}
+
+void TextureUploadQueue::IssueUploads()
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    size_t issuedCount = 0;
+
+    for (size_t i = 0; i < m_stagedCount; ++i)
+    {
+        QueuedUpload* pUpload = m_uploads[i];
+        if (pUpload->isUploaded || !pUpload->counter.IsDone())
+            continue;
+
+        if (issuedCount > 0 && std::chrono::steady_clock::now() - startTime >= uploadTimeBudget)
+            break;
+
+        pUpload->isUploaded = true;
+
+        if (pUpload->textureId == 0)
+            continue;
+
+        if (!pUpload->isDecoded)
+        {
+            // Texture stays empty, materials render without it.
+            fprintf(stderr, "Failed to decode queued texture %u.\n", pUpload->textureId);
+            continue;
+        }
+
+        if (issuedCount == 0)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_stagingBuffer);
+        }
+
+        // Data pointer is an offset into the bound pixel unpack buffer.
+        m_pTextures->UploadTexture(pUpload->textureId, reinterpret_cast<const void*>(pUpload->stagingOffset));
+        pUpload->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ++issuedCount;
+    }
+
+    // Other texture uploads read from client memory.
+    if (issuedCount > 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+}
+
+void TextureUploadQueue::StartDecoding()
+{
+    for (; m_stagedCount < m_uploads.size(); ++m_stagedCount)
+    {
+        QueuedUpload* pUpload = m_uploads[m_stagedCount];
+
+        size_t offset = 0;
+        if (!AllocateStaging(pUpload->size, offset))
+            break;
+
+        pUpload->stagingOffset = offset;
+        pUpload->isStaged = true;
+
+        unsigned char* pDestination = m_pStagingData + offset;
+        auto decode = [pUpload, pDestination]()
+        {
+            pUpload->isDecoded = pUpload->decoder(pDestination);
+        };
+
+        if (m_pJobSystem)
+        {
+            m_pJobSystem->ScheduleBackground(decode, pUpload->counter);
+        }
+        else
+        {
+            decode();
+        }
+    }
+}
+
+bool TextureUploadQueue::AllocateStaging(size_t size, size_t& offset) const
+{
+    if (size > stagingBufferSize)
+        return false;
+
+    if (m_stagedCount == 0)
+    {
+        offset = 0;
+        return true;
+    }
+
+    const QueuedUpload* pFirst = m_uploads.front();
+    const QueuedUpload* pLast = m_uploads[m_stagedCount - 1];
+    const size_t tail = pFirst->stagingOffset;
+    const size_t head = AlignStaging(pLast->stagingOffset + pLast->size);
+
+    if (head > tail)
+    {
+        if (head + size <= stagingBufferSize)
+        {
+            offset = head;
+            return true;
+        }
+
+        // Wraps around to the start of the buffer.
+        if (size <= tail)
+        {
+            offset = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Already wrapped, free memory is between the last and the first staged uploads.
+    if (head + size <= tail)
+    {
+        offset = head;
+        return true;
+    }
+
+    return false;
+}
+
+}
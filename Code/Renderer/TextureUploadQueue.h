@@ -0,0 +1,83 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <deque>
+
+#include "Core/System/JobSystem.h"
+#include "Renderer.h"
+
+namespace VSEngine {
+class MaterialTextures;
+
+// Uploads uncompressed textures without stalling the frame. Storage and id of a texture are allocated
+// when it's queued; its image is decoded by a job into a persistently mapped pixel unpack buffer and
+// copied to the texture from there by Update, within a couple of milliseconds per frame.
+// Staging memory is a ring: it's taken in the order of the queue and given back once the GPU has read it.
+class TextureUploadQueue
+{
+public:
+    static constexpr size_t stagingBufferSize = 64 * 1024 * 1024;
+
+    TextureUploadQueue() = default;
+    TextureUploadQueue(const TextureUploadQueue& other) = delete;
+    TextureUploadQueue(TextureUploadQueue&& other) = delete;
+    ~TextureUploadQueue();
+
+    TextureUploadQueue& operator=(const TextureUploadQueue& other) = delete;
+    TextureUploadQueue& operator=(TextureUploadQueue&& other) = delete;
+
+    // Images are decoded synchronously without job system.
+    void       Initialize(MaterialTextures* pTextures, System::JobSystem* pJobSystem);
+    // Waits for the decoding jobs, textures which aren't uploaded yet stay empty.
+    void       Uninitialize();
+
+    // Returns the id of the texture in MaterialTextures, 0 if it can't be queued, e.g. it's larger than the staging buffer.
+    GLuint     QueueTexture(int width, int height, int channelsCount, TextureDecoder decoder);
+    // Texture is removed before its upload, nothing is written to it.
+    void       CancelTexture(GLuint textureId);
+
+    // Frees the staging memory read by the GPU, issues the uploads of the decoded images and starts decoding
+    // the next ones. Binds buffers and textures behind the state cache.
+    void       Update();
+
+    size_t     GetQueuedTexturesCount() const { return m_uploads.size(); }
+
+private:
+    struct QueuedUpload
+    {
+        // 0 if the texture is removed.
+        GLuint             textureId = 0;
+        size_t             size = 0;
+        TextureDecoder     decoder;
+
+        size_t             stagingOffset = 0;
+        bool               isStaged = false;
+        bool               isDecoded = false;
+        bool               isUploaded = false;
+        // Signaled once the GPU has read the staging memory.
+        GLsync             fence = nullptr;
+        System::JobCounter counter;
+    };
+
+    void       RetireUploads();
+    void       IssueUploads();
+    void       StartDecoding();
+
+    // Takes memory after the last staged upload. Returns false if it doesn't fit before the first one.
+    bool       AllocateStaging(size_t size, size_t& offset) const;
+
+private:
+    MaterialTextures*         m_pTextures = nullptr;
+    System::JobSystem*        m_pJobSystem = nullptr;
+
+    GLuint                    m_stagingBuffer = 0;
+    unsigned char*            m_pStagingData = nullptr;
+
+    // In the order of queueing. Staged uploads are the front of the queue, they are retired from the front.
+    std::deque<QueuedUpload*> m_uploads;
+    size_t                    m_stagedCount = 0;
+};
+
+}
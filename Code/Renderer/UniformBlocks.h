@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace VSEngine {
+
+// CPU mirrors of the std140 uniform blocks and std430 storage blocks declared in the shaders.
+// Every vec3 is followed by a scalar to fill the 16 bytes slot std140 reserves for it.
+
+// Should match "binding" of the blocks in the shaders.
+constexpr unsigned int frameConstantsBinding = 0;
+constexpr unsigned int lightsBinding = 1;
+// Shader storage bindings.
+constexpr unsigned int materialsBinding = 0;
+constexpr unsigned int pointLightsBinding = 1;
+constexpr unsigned int lightClustersBinding = 2;
+constexpr unsigned int clusterLightIndicesBinding = 3;
+constexpr unsigned int convolutionWeightsBinding = 4;
+
+struct FrameConstantsBlock
+{
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    glm::mat4 projMatrix = glm::mat4(1.0f);
+    // World space, w is unused.
+    glm::vec4 cameraPosition = glm::vec4(0.0f);
+};
+
+// All the light positions and directions are in view space.
+struct DirectionalLightBlock
+{
+    glm::vec3 direction = glm::vec3(0.0f);
+    float     padding0 = 0.0f;
+    glm::vec3 ambient = glm::vec3(0.0f);
+    float     padding1 = 0.0f;
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    float     padding2 = 0.0f;
+    glm::vec3 specular = glm::vec3(0.0f);
+    float     padding3 = 0.0f;
+};
+
+struct PointLightBlock
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float     constant = 1.0f;
+    glm::vec3 ambient = glm::vec3(0.0f);
+    float     linear = 0.0f;
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    float     quadratic = 0.0f;
+    glm::vec3 specular = glm::vec3(0.0f);
+    // Distance at which the light becomes negligible. Used for the cluster assignment only.
+    float     radius = 0.0f;
+};
+
+struct SpotlightBlock
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float     constant = 1.0f;
+    glm::vec3 direction = glm::vec3(0.0f);
+    float     linear = 0.0f;
+    glm::vec3 ambient = glm::vec3(0.0f);
+    float     quadratic = 0.0f;
+    glm::vec3 diffuse = glm::vec3(0.0f);
+    float     cutOff = 0.0f;
+    glm::vec3 specular = glm::vec3(0.0f);
+    float     outerCutOff = 0.0f;
+};
+
+struct LightsBlock
+{
+    DirectionalLightBlock directionalLight;
+    SpotlightBlock        flashlight;
+
+    int                   directionalLightsCount = 0;
+    int                   flashlightsCount = 0;
+    int                   pointLightsCount = 0;
+    int                   padding = 0;
+
+    // Point lights are in the storage buffer, fragments take them from their cluster only.
+    glm::uvec4            clusterGridSize = glm::uvec4(0);
+    // xy: clusters per pixel, z and w: scale and bias of the depth slice, see LightClusters.
+    glm::vec4             clusterParameters = glm::vec4(0.0f);
+};
+
+// Element of the light clusters storage buffer: range of the cluster light indices.
+struct LightClusterBlock
+{
+    uint32_t offset = 0;
+    uint32_t count = 0;
+};
+
+// Element of the materials storage buffer.
+struct MaterialBlock
+{
+    glm::vec3  ambient = glm::vec3(1.0f);
+    float      shininess = 32.0f;
+    glm::vec3  diffuse = glm::vec3(1.0f);
+    float      opacity = 1.0f;
+    glm::vec3  specular = glm::vec3(1.0f);
+    float      padding = 0.0f;
+    // References of MaterialTextures, valid if the variant of the material samples the map.
+    glm::uvec2 diffuseMap = glm::uvec2(0);
+    glm::uvec2 specularMap = glm::uvec2(0);
+};
+
+static_assert(sizeof(FrameConstantsBlock) == 144, "FrameConstantsBlock doesn't match std140 layout");
+static_assert(sizeof(DirectionalLightBlock) == 64, "DirectionalLightBlock doesn't match std140 layout");
+static_assert(sizeof(PointLightBlock) == 64, "PointLightBlock doesn't match std140 layout");
+static_assert(sizeof(SpotlightBlock) == 80, "SpotlightBlock doesn't match std140 layout");
+static_assert(sizeof(LightsBlock) == 192, "LightsBlock doesn't match std140 layout");
+static_assert(sizeof(LightClusterBlock) == 8, "LightClusterBlock doesn't match std430 layout");
+static_assert(sizeof(MaterialBlock) == 64, "MaterialBlock doesn't match std430 layout");
+
+}
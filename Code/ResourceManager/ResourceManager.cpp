@@ -4,10 +4,14 @@
 #include "ObjectModel/Material.h"
 #include "Scene/Components/SceneObject.h"
 #include "Utils/CommonUtils.h"
+#include "Utils/DDSFile.h"
+#include "Utils/TextureCompression.h"
 
 #include "Core/Engine.h"
 #include "Renderer/Renderer.h"
 
+#include <cstring>
+#include <filesystem>
 #include <thread>
 
 #include <assimp/Importer.hpp>
@@ -19,6 +23,60 @@
 
 namespace VSEngine {
 namespace Resource {
+namespace {
+// Cooked texture is used unless its source image has been modified after cooking.
+unsigned int LoadCookedTexture(const char* pathToTexture, Renderer* pRenderer)
+{
+    const std::string cookedPath = VSUtils::GetCookedTexturePath(pathToTexture);
+
+    std::error_code error;
+    const auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+    if (error)
+        return 0;
+
+    const auto sourceTime = std::filesystem::last_write_time(pathToTexture, error);
+    if (!error && sourceTime > cookedTime)
+        return 0;
+
+    // Streaming renderers read the levels by themselves.
+    const unsigned int streamedTextureId = pRenderer->GetStreamedTextureRenderInfo(cookedPath.c_str());
+    if (streamedTextureId != 0)
+        return streamedTextureId;
+
+    VSUtils::CompressedTexture texture;
+    if (!VSUtils::LoadDDS(cookedPath.c_str(), texture))
+        return 0;
+
+    return pRenderer->GetCompressedTextureRenderInfo(texture);
+}
+
+// Only the header of the image is read here, it's decoded by a worker of the renderer.
+unsigned int QueueTexture(const char* pathToTexture, Renderer* pRenderer)
+{
+    int width = 0, height = 0, channelsCount = 0;
+    if (!stbi_info(pathToTexture, &width, &height, &channelsCount))
+        return 0;
+
+    const std::string path(pathToTexture);
+    auto decoder = [path, width, height, channelsCount](unsigned char* pDestination)
+    {
+        // stb_image allocates the image by itself, it's copied to the staging memory.
+        int decodedWidth = 0, decodedHeight = 0, decodedChannelsCount = 0;
+        unsigned char* pData = stbi_load(path.c_str(), &decodedWidth, &decodedHeight, &decodedChannelsCount, channelsCount);
+        const bool isDecoded = pData != nullptr && decodedWidth == width && decodedHeight == height;
+        if (isDecoded)
+        {
+            memcpy(pDestination, pData, static_cast<size_t>(width) * height * channelsCount);
+        }
+
+        stbi_image_free(pData);
+
+        return isDecoded;
+    };
+
+    return pRenderer->GetQueuedTextureRenderInfo(width, height, channelsCount, decoder);
+}
+}
 
 ResourceManager::~ResourceManager()
 {
@@ -253,6 +311,10 @@ Material* ResourceManager::ProcessMaterial(aiMaterial* pAiMat, Mesh* pMesh, cons
     pAiMat->Get(AI_MATKEY_SHININESS, shininess);
     vsMaterial.SetShininess(shininess);
 
+    float opacity = 1.0f;
+    pAiMat->Get(AI_MATKEY_OPACITY, opacity);
+    vsMaterial.SetOpacity(opacity);
+
     return &vsMaterial;
 }
 
@@ -269,13 +331,23 @@ const Texture* ResourceManager::LoadTexture(const char* pathToTexture, TextureTy
     if (pRenderer == nullptr)
         return nullptr;
 
-    int width = 0, height = 0, channelsCount = 0;
-    unsigned char* data = stbi_load(pathToTexture, &width, &height, &channelsCount, 0);
+    unsigned int textureId = LoadCookedTexture(pathToTexture, pRenderer);
+    if (textureId == 0)
+    {
+        textureId = QueueTexture(pathToTexture, pRenderer);
+    }
 
-    const unsigned int textureId = pRenderer->GetTextureRenderInfo(data, width, height, channelsCount);
-    Texture texture(textureId, type, pathToTexture);
+    if (textureId == 0)
+    {
+        int width = 0, height = 0, channelsCount = 0;
+        unsigned char* data = stbi_load(pathToTexture, &width, &height, &channelsCount, 0);
+
+        textureId = pRenderer->GetTextureRenderInfo(data, width, height, channelsCount);
 
-    stbi_image_free(data);
+        stbi_image_free(data);
+    }
+
+    Texture texture(textureId, type, pathToTexture);
 
     auto result = m_textureMap.emplace(pathToTexture, std::move(texture));
 
@@ -40,10 +40,14 @@ public:
 
     [[nodiscard]] const glm::vec3& GetViewPosition() const;
     [[nodiscard]] const glm::vec3& GetViewDirection() const;
+    [[nodiscard]] const glm::vec3& GetUpDirection() const { return m_upDirection; }
+    [[nodiscard]] const glm::vec3& GetWorldUpDirection() const { return m_worldUpDirection; }
 
     void                           SetFoV(float deltaFoV);
     [[nodiscard]] float            GetFoV() const;
 
+    [[nodiscard]] float            GetAspectRatio() const { return m_aspectRatio; }
+
     void                           SetZNear(float zNear);
     [[nodiscard]] float            GetZNear() const;
 
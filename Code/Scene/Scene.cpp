@@ -4,10 +4,14 @@
 #include "Renderer/ShaderProgram.h"
 
 #include "Core/Engine.h"
+#include "Core/System/JobSystem.h"
+#include "Core/System/Profiler.h"
 
 #include <GL/glew.h>
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace VSEngine {
 
@@ -64,16 +68,12 @@ void Scene::Unload()
     }
 }
 
-void Scene::RenderScene(double time, const glm::mat4& projMatrix,
-                        const VSUtils::ShaderProgram& shaderProgram)
+void Scene::RenderScene(double time, const VSUtils::ShaderProgram& shaderProgram)
 {
-    // Render light source as box, if needed
+    // Render light source as box, if needed. View and projection come from the FrameConstants block.
     const size_t lightCount = m_lights.size();
     for (size_t i = 0; i < lightCount; ++i)
     {
-        shaderProgram.SetMat4("viewMatrix", m_camera.GetViewMatrix());
-        shaderProgram.SetMat4("projMatrix", projMatrix);
-
         if (m_lights[i].GetLightType() == LightType::Point)
         {
             m_lights[i].Render();
@@ -84,34 +84,161 @@ void Scene::RenderScene(double time, const glm::mat4& projMatrix,
 void Scene::AddSceneObject(SceneObject* pObject)
 {
     m_octree.AddObject(pObject);
+
+    InvalidateViews();
+}
+
+void Scene::InvalidateViews()
+{
+    m_mainView.cullingCache.Invalidate();
+    for (SceneView& view : m_additionalViews)
+    {
+        view.cullingCache.Invalidate();
+    }
+
+    m_needSceneUpdate = true;
 }
 
 void Scene::SetCamera(const Camera& cam)
 {
-    m_camera = cam;
+    m_mainView.camera = cam;
+    m_mainView.cullingCache.Invalidate();
+
+    m_renderCamera = cam;
+    SaveState();
+
     m_needSceneUpdate = true;
 }
 
 void Scene::MoveCamera(MoveDirection direction)
 {
-    m_camera.MoveCamera(direction);
+    m_mainView.camera.MoveCamera(direction);
     m_needSceneUpdate = true;
 }
 
 void Scene::RotateCamera(float deltaYaw, float deltaPitch)
 {
-    m_camera.RotateCamera(deltaYaw, deltaPitch);
+    m_mainView.camera.RotateCamera(deltaYaw, deltaPitch);
     m_needSceneUpdate = true;
 }
 
+size_t Scene::AddView(const Camera& camera)
+{
+    if (GetViewsCount() >= SpatialSystem::maxViewsCount)
+        return invalidViewIndex;
+
+    m_additionalViews.emplace_back(camera);
+    m_needSceneUpdate = true;
+
+    return m_additionalViews.size();
+}
+
+void Scene::RemoveAdditionalViews()
+{
+    m_additionalViews.clear();
+}
+
+void Scene::SetViewCamera(size_t viewIndex, const Camera& camera)
+{
+    if (viewIndex == mainViewIndex)
+    {
+        SetCamera(camera);
+        return;
+    }
+
+    SceneView& view = GetView(viewIndex);
+    view.camera = camera;
+    view.cullingCache.Invalidate();
+
+    m_needSceneUpdate = true;
+}
+
+const SceneView& Scene::GetView(size_t viewIndex) const
+{
+    return viewIndex == mainViewIndex ? m_mainView : m_additionalViews[viewIndex - 1];
+}
+
+SceneView& Scene::GetView(size_t viewIndex)
+{
+    return viewIndex == mainViewIndex ? m_mainView : m_additionalViews[viewIndex - 1];
+}
+
+void Scene::SaveState()
+{
+    const Camera& camera = m_mainView.camera;
+    m_prevCameraPosition = camera.GetViewPosition();
+    m_prevCameraDirection = camera.GetViewDirection();
+}
+
+void Scene::InterpolateState(float factor)
+{
+    const Camera& camera = m_mainView.camera;
+
+    // Projection parameters aren't simulated, take them as is.
+    m_renderCamera = camera;
+
+    const glm::vec3 position = glm::mix(m_prevCameraPosition, camera.GetViewPosition(), factor);
+    const glm::vec3 direction = glm::mix(m_prevCameraDirection, camera.GetViewDirection(), factor);
+    if (glm::length(direction) < VSUtils::Tolerance)
+        return;
+
+    m_renderCamera.Set(position, glm::normalize(direction), camera.GetWorldUpDirection());
+}
+
 void Scene::UpdateScene()
 {
     if (m_needSceneUpdate == false)
         return;
 
-    m_sortedSceneObjects.clear();
+    System::ScopedCpuTimer cullingTimer(GetEngine().GetProfiler(), "Culling");
+
+    System::JobSystem* pJobSystem = GetEngine().GetJobSystem();
+
+    // Octree is traversed only for the views which left the guard band of their previous culling,
+    // and all of them share a single traversal.
+    std::vector<size_t> staleViews;
+    std::vector<VSUtils::Frustum> guardFrustums;
+
+    const size_t viewsCount = GetViewsCount();
+    for (size_t viewIndex = 0; viewIndex < viewsCount; ++viewIndex)
+    {
+        const SceneView& view = GetView(viewIndex);
+        if (!view.cullingCache.IsValid(view.camera))
+        {
+            staleViews.push_back(viewIndex);
+            guardFrustums.push_back(view.cullingCache.MakeGuardFrustum(view.camera));
+        }
+    }
+
+    if (!staleViews.empty())
+    {
+        SpatialSystem::ViewObjects guardObjects;
+        m_octree.GetObjectsInside(guardFrustums, guardObjects, pJobSystem);
+
+        for (size_t i = 0; i < staleViews.size(); ++i)
+        {
+            SceneView& view = GetView(staleViews[i]);
+            view.cullingCache.Rebuild(view.camera, guardObjects[i]);
+        }
+    }
+
+    for (size_t viewIndex = 0; viewIndex < viewsCount; ++viewIndex)
+    {
+        SceneView& view = GetView(viewIndex);
+
+        view.visibleObjects.clear();
+        view.cullingCache.GetVisibleObjects(view.camera.GetFrustum(), view.visibleObjects);
+
+        SortByDistance(view);
+    }
+
+    m_needSceneUpdate = false;
+}
 
-    const VSUtils::Frustum& frustum = m_camera.GetFrustum();
+void Scene::SortByDistance(SceneView& view)
+{
+    std::vector<SceneObject*>& objects = view.visibleObjects;
+    const glm::vec3& position = view.camera.GetViewPosition();
 
     constexpr auto SqDistance = [](const glm::vec3& lhs, const glm::vec3& rhs) -> float
     {
@@ -119,21 +246,58 @@ void Scene::UpdateScene()
         return dot(diff, diff);
     };
 
-    m_sortedSceneObjects = m_octree.GetObjectsInside(frustum);
-    std::sort(m_sortedSceneObjects.begin(), m_sortedSceneObjects.end(), [&](const SceneObject* lhs, const SceneObject* rhs)
-    {
-        if (lhs == nullptr || rhs == nullptr)
-            return false;
+    // Distances are calculated once per object in parallel, sorting only compares precalculated keys.
+    const size_t objectsCount = objects.size();
+    m_sortKeys.resize(objectsCount);
 
-        const glm::vec3& cameraPos = m_camera.GetViewPosition();
+    auto calculateKeys = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            SceneObject* pObject = objects[i];
+            const float distToCamera = pObject ? SqDistance(pObject->GetBoundingBox().GetCenter(), position) :
+                                                 std::numeric_limits<float>::max();
+            m_sortKeys[i] = std::make_pair(distToCamera, pObject);
+        }
+    };
 
-        const float distToCameraLeft = SqDistance(lhs->GetBoundingBox().GetCenter(), cameraPos);
-        const float distToCameraRight = SqDistance(rhs->GetBoundingBox().GetCenter(), cameraPos);
+    constexpr size_t sortKeysBatchSize = 256;
+    System::JobSystem* pJobSystem = GetEngine().GetJobSystem();
+    if (pJobSystem == nullptr)
+    {
+        calculateKeys(0, objectsCount);
+    }
+    else
+    {
+        pJobSystem->ParallelFor(objectsCount, sortKeysBatchSize, calculateKeys);
+    }
 
-        return distToCameraLeft < distToCameraRight;
+    std::sort(m_sortKeys.begin(), m_sortKeys.end(), [](const std::pair<float, SceneObject*>& lhs,
+                                                       const std::pair<float, SceneObject*>& rhs)
+    {
+        return lhs.first < rhs.first;
     });
 
-    m_needSceneUpdate = false;
+    // Sphere of radius r at distance d covers r / (d * tan(fov / 2)) of the viewport height.
+    // Scale is taken from the rendered projection, FoV of the camera is in degrees.
+    const float projectionScale = view.camera.GetProjectionMatrix()[1][1];
+    view.screenSizes.resize(objectsCount);
+
+    for (size_t i = 0; i < objectsCount; ++i)
+    {
+        SceneObject* pObject = m_sortKeys[i].second;
+        objects[i] = pObject;
+
+        float screenSize = 0.0f;
+        if (pObject)
+        {
+            const float radius = 0.5f * glm::length(pObject->GetBoundingBox().GetDimensionsSize());
+            const float distance = std::sqrt(m_sortKeys[i].first);
+            screenSize = radius > 0.0f ? radius / std::max(distance, radius) * projectionScale : 0.0f;
+        }
+
+        view.screenSizes[i] = screenSize;
+    }
 }
 
 
@@ -3,10 +3,12 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <utility>
 #include <vector>
 
 #include "Scene/Components/Camera.h"
 #include "Scene/Components/Light.h"
+#include "SpatialSystem/CullingCache.h"
 #include "SpatialSystem/Octree.h"
 
 #include "glm/glm.hpp"
@@ -18,6 +20,24 @@ class ShaderProgram;
 namespace VSEngine {
 class SceneObject;
 
+constexpr size_t mainViewIndex = 0;
+constexpr size_t invalidViewIndex = static_cast<size_t>(-1);
+
+// Camera with its own list of visible objects.
+struct SceneView
+{
+    SceneView(const Camera& camera_)
+        : camera(camera_)
+    {}
+
+    Camera                      camera;
+    SpatialSystem::CullingCache cullingCache;
+    // Sorted front to back.
+    std::vector<SceneObject*>   visibleObjects;
+    // Diameters of the bounding spheres of the visible objects in fractions of the viewport height.
+    std::vector<float>          screenSizes;
+};
+
 class Scene
 {
 public:
@@ -32,38 +52,75 @@ public:
     void                                           Load();
     void                                           Unload();
 
-    void                                           RenderScene(double time, const glm::mat4& projMatrix,
-                                                               const VSUtils::ShaderProgram& shaderProgram);
+    void                                           RenderScene(double time, const VSUtils::ShaderProgram& shaderProgram);
 
     void                                           AddSceneObject(SceneObject* object);
 
     void                                           SetCamera(const Camera& camera);
-    [[nodiscard]] const Camera&                    GetCamera() const { return m_camera; }
-    [[nodiscard]] Camera&                          GetCamera() { return m_camera; }
+    [[nodiscard]] const Camera&                    GetCamera() const { return m_mainView.camera; }
+    [[nodiscard]] Camera&                          GetCamera() { return m_mainView.camera; }
+
+    // Camera state between the last two simulation steps. Use it for rendering.
+    [[nodiscard]] const Camera&                    GetRenderCamera() const { return m_renderCamera; }
 
     void                                           MoveCamera(MoveDirection direction);
     void                                           RotateCamera(float deltaYaw, float deltaPitch);
 
+    // Renderer uses any number of point lights, one directional light and one spotlight.
+    void                                           AddLight(const Light& light) { m_lights.push_back(light); }
     [[nodiscard]] unsigned short                   GetLightsCount() const { return m_lights.size(); }
     [[nodiscard]] const std::vector<Light>&        GetLights() const { return m_lights; }
 
-    [[nodiscard]] const std::vector<SceneObject*>& GetSceneObjects() const { return m_sortedSceneObjects; }
-
+    [[nodiscard]] const std::vector<SceneObject*>& GetSceneObjects() const { return m_mainView.visibleObjects; }
+    // In the order of GetSceneObjects, see SceneView::screenSizes.
+    [[nodiscard]] const std::vector<float>&        GetSceneObjectScreenSizes() const { return m_mainView.screenSizes; }
+
+    // Additional views (shadow maps, split screen, reflections). All the views are culled
+    // in a single octree traversal. Main camera is the view with mainViewIndex.
+    // Returns invalidViewIndex if there are already SpatialSystem::maxViewsCount views.
+    size_t                                         AddView(const Camera& camera);
+    void                                           RemoveAdditionalViews();
+    void                                           SetViewCamera(size_t viewIndex, const Camera& camera);
+    [[nodiscard]] size_t                           GetViewsCount() const { return m_additionalViews.size() + 1; }
+    [[nodiscard]] const Camera&                    GetViewCamera(size_t viewIndex) const { return GetView(viewIndex).camera; }
+    [[nodiscard]] const std::vector<SceneObject*>& GetViewObjects(size_t viewIndex) const { return GetView(viewIndex).visibleObjects; }
+
+    // Views are culled again by the next UpdateScene, e.g. after their projection has changed.
+    void                                           InvalidateViews();
     void                                           UpdateScene();
 
+    // Remembers the current state as previous one. Called at the beginning of every simulation step.
+    void                                           SaveState();
+    // Blends previous and current states into the render state, factor is in [0, 1].
+    void                                           InterpolateState(float factor);
+
+private:
+    [[nodiscard]] const SceneView&                 GetView(size_t viewIndex) const;
+    [[nodiscard]] SceneView&                       GetView(size_t viewIndex);
+
+    // Sorts the visible objects of the view and calculates their screen sizes.
+    void                                           SortByDistance(SceneView& view);
+
 private:
-    Camera                    m_camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
-                                                glm::vec3(0.0f, -1.0f, 0.0f),
-                                                glm::vec3(0.0f, 1.0f, 0.0f));
+    SceneView                                   m_mainView = SceneView(Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+                                                                              glm::vec3(0.0f, -1.0f, 0.0f),
+                                                                              glm::vec3(0.0f, 1.0f, 0.0f)));
+    std::vector<SceneView>                      m_additionalViews;
+
+    Camera                                      m_renderCamera = m_mainView.camera;
+
+    glm::vec3                                   m_prevCameraPosition = m_mainView.camera.GetViewPosition();
+    glm::vec3                                   m_prevCameraDirection = m_mainView.camera.GetViewDirection();
 
-    std::vector<SceneObject*> m_sortedSceneObjects;
+    // Distance to camera for every visible object. Kept between updates to avoid reallocations.
+    std::vector<std::pair<float, SceneObject*>> m_sortKeys;
 
-    SpatialSystem::Octree     m_octree;
+    SpatialSystem::Octree                       m_octree;
 
     // Light sources
-    std::vector<Light>        m_lights;
+    std::vector<Light>                          m_lights;
 
-    bool                      m_needSceneUpdate = false;
+    bool                                        m_needSceneUpdate = false;
 };
 
 }
@@ -0,0 +1,7 @@
+// Layout should match Renderer/UniformBlocks.h
+layout (std140, binding = 0) uniform FrameConstants
+{
+	mat4 viewMatrix;
+	mat4 projMatrix;
+	vec4 cameraPosition;
+};
@@ -0,0 +1,79 @@
+// Layouts should match Renderer/UniformBlocks.h
+struct DirectionalLight
+{
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight
+{
+    vec3 position;
+    // Attenuation parameters and radius are packed into the padding of vec3.
+    float constant;
+
+    vec3 ambient;
+    float linear;
+    vec3 diffuse;
+    float quadratic;
+    vec3 specular;
+    float radius;
+};
+
+struct Spotlight
+{
+    vec3 position;
+    float constant;
+    vec3 direction;
+    float linear;
+
+    vec3 ambient;
+    float quadratic;
+    vec3 diffuse;
+    float cutOff;
+    vec3 specular;
+    float outerCutOff;
+};
+
+layout (std140, binding = 1) uniform Lights
+{
+    DirectionalLight directionalLight;
+    Spotlight flashlight;
+
+    int directionalLightsCount;
+    int flashlightsCount;
+    int pointLightsCount;
+
+    uvec4 clusterGridSize;
+    // xy: clusters per pixel, z and w: scale and bias of the depth slice.
+    vec4 clusterParameters;
+};
+
+// Clustered point lights, see Renderer/LightClusters.h
+layout (std430, binding = 1) readonly buffer PointLights
+{
+    PointLight pointLights[];
+};
+
+// x: offset in lightIndices, y: lights count.
+layout (std430, binding = 2) readonly buffer LightClusters
+{
+    uvec2 lightClusters[];
+};
+
+layout (std430, binding = 3) readonly buffer ClusterLightIndices
+{
+    uint lightIndices[];
+};
+
+uint GetClusterIndex(vec2 fragmentCoord, float viewDepth)
+{
+    uvec3 cluster;
+    cluster.xy = uvec2(fragmentCoord * clusterParameters.xy);
+    cluster.z = uint(max(log(viewDepth) * clusterParameters.z + clusterParameters.w, 0.0));
+    cluster = min(cluster, clusterGridSize.xyz - uvec3(1));
+
+    return cluster.x + clusterGridSize.x * (cluster.y + clusterGridSize.y * cluster.z);
+}
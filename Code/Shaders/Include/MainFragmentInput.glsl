@@ -0,0 +1,9 @@
+// Output of Main/Main.vs.glsl.
+in VS_OUT 
+{
+    vec3 normal;
+    vec3 fragmentPosition;
+    vec2 textureCoord;
+    flat vec3 meshColor;
+    flat uint materialIndex;
+} fsIn;
@@ -0,0 +1,35 @@
+// Layout should match Renderer/UniformBlocks.h
+struct Material
+{
+    vec3 ambient;
+    float shininess;
+    vec3 diffuse;
+    float opacity;
+    vec3 specular;
+    // Texture references, see SampleMaterialMap.
+    uvec2 diffuseMap;
+    uvec2 specularMap;
+};
+
+layout (std430, binding = 0) readonly buffer Materials
+{
+    Material materials[];
+};
+
+// With BINDLESS_TEXTURES a reference is the texture handle, which requires GL_ARB_bindless_texture
+// to be enabled by the shader right after #version. Otherwise it's the array and the layer.
+#ifndef BINDLESS_TEXTURES
+// Should match MaterialTextures::maxTextureArraysCount, arrays take the units from 0.
+#define MAX_TEXTURE_ARRAYS 16
+layout (binding = 0) uniform sampler2DArray materialTextureArrays[MAX_TEXTURE_ARRAYS];
+#endif
+
+// Material of a draw is the same for all its fragments, so the array index is dynamically uniform.
+vec4 SampleMaterialMap(uvec2 map, vec2 textureCoord)
+{
+#ifdef BINDLESS_TEXTURES
+    return texture(sampler2D(map), textureCoord);
+#else
+    return texture(materialTextureArrays[map.x], vec3(textureCoord, float(map.y)));
+#endif
+}
@@ -2,8 +2,8 @@
 
 layout (location = 0) in vec3 position;
 
-uniform mat4 projMatrix;
-uniform mat4 viewMatrix;
+#include "Include/FrameConstants.glsl"
+
 uniform mat4 modelMatrix;
 
 void main()
@@ -0,0 +1,21 @@
+#version 430 core
+#ifdef BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
+
+#include "Include/MainFragmentInput.glsl"
+#include "Include/Materials.glsl"
+
+// Variant defines: HAS_DIFFUSE_MAP and BINDLESS_TEXTURES, see Main.fs.glsl.
+// Without diffuse map nothing is discarded, so the variant has no work besides the depth.
+
+void main()
+{
+#ifdef HAS_DIFFUSE_MAP
+    // Same alpha test as Main.fs.glsl, otherwise cut-out texels would hide what is behind them.
+    if (SampleMaterialMap(materials[fsIn.materialIndex].diffuseMap, fsIn.textureCoord).a < 0.01)
+    {
+        discard;
+    }
+#endif
+}
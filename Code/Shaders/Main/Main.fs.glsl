@@ -1,77 +1,18 @@
 #version 430 core
+#ifdef BINDLESS_TEXTURES
+#extension GL_ARB_bindless_texture : require
+#endif
 
 out vec4 color;
 
-in VS_OUT 
-{
-    vec3 normal;
-    vec3 fragmentPosition;
-    vec2 textureCoord;
-} fsIn;
-
-struct DirectionalLight
-{
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight
-{
-    vec3 position;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    // Attenuation parameters
-    float constant;
-    float linear;
-    float quadratic;	
-};
-#define POINT_LIGHTS_COUNT 1
-
-struct Spotlight
-{
-    vec3 position;
-    vec3 direction;
+#include "Include/MainFragmentInput.glsl"
+#include "Include/Materials.glsl"
+#include "Include/Lights.glsl"
 
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    // Attenuation parameters
-    float constant;
-    float linear;
-    float quadratic;
-
-    float cutOff;
-    float outerCutOff;
-};
-
-struct Material
-{
-    sampler2D diffuseMap1;
-    sampler2D diffuseMap2;
-    sampler2D diffuseMap3;
-    sampler2D specularMap1;
-    sampler2D specularMap2;
-    sampler2D specularMap3;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float shininess;
-};
-
-uniform vec3 meshColor;
-uniform Material material;
-uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[POINT_LIGHTS_COUNT];
-//uniform Spotlight flashlight;
+// Variant defines:
+// HAS_DIFFUSE_MAP, HAS_SPECULAR_MAP - material textures are sampled, material colors are used otherwise.
+// DIRECTIONAL_LIGHT, POINT_LIGHTS, FLASHLIGHT - light types present in the scene.
+// BINDLESS_TEXTURES - material textures are referenced by handles, see Include/Materials.glsl.
 
 vec3 CalculateDirectionalLight(DirectionalLight dirLight, vec3 normal, vec3 viewDir, 
                                vec4 diffuseTex, vec4 specularTex);
@@ -84,30 +25,43 @@ void main()
 {
     vec3 viewDir = -normalize(fsIn.fragmentPosition);
     vec3 normal = normalize(fsIn.normal);
-    vec4 diffuseTex = texture(material.diffuseMap1, fsIn.textureCoord);
+#ifdef HAS_DIFFUSE_MAP
+    vec4 diffuseTex = SampleMaterialMap(materials[fsIn.materialIndex].diffuseMap, fsIn.textureCoord);
     if (diffuseTex.a < 0.01)
     {
         discard;
     }
-
-    vec4 specularTex = texture(material.specularMap1, fsIn.textureCoord);
-
-    vec3 outputColor = CalculateDirectionalLight(directionalLight, normal, viewDir, 
-                                                 diffuseTex, specularTex);
-
-    for (int i = 0; i < POINT_LIGHTS_COUNT; ++i)
+#else
+    vec4 diffuseTex = vec4(materials[fsIn.materialIndex].diffuse, 1.0);
+#endif
+
+#ifdef HAS_SPECULAR_MAP
+    vec4 specularTex = SampleMaterialMap(materials[fsIn.materialIndex].specularMap, fsIn.textureCoord);
+#else
+    vec4 specularTex = vec4(materials[fsIn.materialIndex].specular, 1.0);
+#endif
+
+    vec3 outputColor = vec3(0.0);
+#ifdef DIRECTIONAL_LIGHT
+    outputColor += CalculateDirectionalLight(directionalLight, normal, viewDir, 
+                                             diffuseTex, specularTex);
+#endif
+
+#ifdef POINT_LIGHTS
+    uvec2 cluster = lightClusters[GetClusterIndex(gl_FragCoord.xy, -fsIn.fragmentPosition.z)];
+    for (uint i = 0; i < cluster.y; ++i)
     {
-        outputColor += CalculatePointLight(pointLights[i], normal, fsIn.fragmentPosition, 
+        outputColor += CalculatePointLight(pointLights[lightIndices[cluster.x + i]], normal, fsIn.fragmentPosition, 
                                            viewDir, diffuseTex, specularTex);
     }
+#endif
 
+#ifdef FLASHLIGHT
+    outputColor += CalculateSpotLight(flashlight, normal, fsIn.fragmentPosition, 
+                                      viewDir, diffuseTex, specularTex);
+#endif
 
-    // Possible to define also spotlight
-    /*outputColor += CalculateSpotLight(flashlight, normal, fsIn.fragmentPosition, 
-                                      viewDir, diffuseTex, specularTex);*/
-
-
-    color = vec4(outputColor, 1.0);
+    color = vec4(outputColor, materials[fsIn.materialIndex].opacity);
 }
 
 vec3 CalculateDirectionalLight(DirectionalLight dirLight, vec3 normal, vec3 viewDir, 
@@ -120,7 +74,7 @@ vec3 CalculateDirectionalLight(DirectionalLight dirLight, vec3 normal, vec3 view
 
     // Specular component
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(reflectDir, viewDir), 0.0), material.shininess);
+    float spec = pow(max(dot(reflectDir, viewDir), 0.0), materials[fsIn.materialIndex].shininess);
 
     // Total
     vec3 ambient = dirLight.ambient * diffuseTex.rgb;
@@ -145,7 +99,7 @@ vec3 CalculatePointLight(PointLight pointLight, vec3 normal, vec3 fragmentPositi
 
     // Specular component
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(reflectDir, viewDir), 0.0), material.shininess);
+    float spec = pow(max(dot(reflectDir, viewDir), 0.0), materials[fsIn.materialIndex].shininess);
 
     // Total
     vec3 ambient = pointLight.ambient * diffuseTex.rgb;
@@ -170,7 +124,7 @@ vec3 CalculateSpotLight(Spotlight spotlight, vec3 normal, vec3 fragmentPosition,
 
     // Specular component
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(reflectDir, viewDir), 0.0), material.shininess);
+    float spec = pow(max(dot(reflectDir, viewDir), 0.0), materials[fsIn.materialIndex].shininess);
 
     // spotlight attenuation
     float theta = dot(lightDir, normalize(-spotlight.direction));
@@ -3,17 +3,24 @@
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 normal;
 layout (location = 2) in vec2 textureCoord;
+// Per-instance attributes
+layout (location = 3) in mat4 modelMatrix;
+layout (location = 7) in vec4 meshColor;
+layout (location = 8) in uint materialIndex;
 
 out VS_OUT
 {
 	vec3 normal;
 	vec3 fragmentPosition;
 	vec2 textureCoord;
+	flat vec3 meshColor;
+	flat uint materialIndex;
 } vsOut;
 
-uniform mat4 projMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 modelMatrix;
+// Depth pre-pass uses this shader with another fragment shader, shading pass tests depth with GL_EQUAL.
+invariant gl_Position;
+
+#include "Include/FrameConstants.glsl"
 
 void main()
 {
@@ -22,4 +29,6 @@ void main()
 	vsOut.normal = mat3(mvMatrix) * normal; //mat3(transpose(inverse(mvMatrix))) * normal; // calculate normal matrix on the CPU and send as uniform
 	vsOut.fragmentPosition = vec3(mvMatrix * vec4(position, 1.0));
 	vsOut.textureCoord = textureCoord;
+	vsOut.meshColor = meshColor.rgb;
+	vsOut.materialIndex = materialIndex;
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 430 core
+
+out vec4 color;
+
+#include "Include/MainFragmentInput.glsl"
+#include "Include/Materials.glsl"
+
+// Drawn while the variant of the material is compiled: material color lit from the camera.
+void main()
+{
+    float light = 0.3 + 0.7 * max(dot(normalize(fsIn.normal), -normalize(fsIn.fragmentPosition)), 0.0);
+
+    color = vec4(materials[fsIn.materialIndex].diffuse * light, materials[fsIn.materialIndex].opacity);
+}
@@ -0,0 +1,61 @@
+#version 430 core
+
+// Should match convolutionTileSize and maxComputeKernelRadius in GLRenderer.cpp
+#define TILE_SIZE  16
+#define MAX_RADIUS 8
+#define CACHE_SIZE (TILE_SIZE + 2 * MAX_RADIUS)
+
+layout (local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+layout (binding = 0) uniform sampler2D sourceTexture;
+layout (binding = 0, rgba8) uniform writeonly image2D targetImage;
+
+// Should match convolutionWeightsBinding in UniformBlocks.h
+// Row major, the top row first. Storage block, since 17x17 weights may exceed the uniform limit of compute shaders.
+layout (std430, binding = 4) readonly buffer ConvolutionWeights
+{
+    float weights[];
+};
+
+uniform int radius;
+
+// Tile with its apron, so every source texel is fetched once per work group.
+shared vec3 cache[CACHE_SIZE][CACHE_SIZE];
+
+void main()
+{
+    const ivec2 size = textureSize(sourceTexture, 0);
+    const ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * TILE_SIZE - ivec2(radius);
+    const int cacheSize = TILE_SIZE + 2 * radius;
+
+    for(int y = int(gl_LocalInvocationID.y); y < cacheSize; y += TILE_SIZE)
+    {
+        for(int x = int(gl_LocalInvocationID.x); x < cacheSize; x += TILE_SIZE)
+        {
+            const ivec2 texel = clamp(tileOrigin + ivec2(x, y), ivec2(0), size - ivec2(1));
+            cache[y][x] = texelFetch(sourceTexture, texel, 0).rgb;
+        }
+    }
+
+    barrier();
+
+    const ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, size)))
+        return;
+
+    const ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    const int kernelSize = 2 * radius + 1;
+
+    vec3 color = vec3(0.0);
+    for(int ky = 0; ky < kernelSize; ++ky)
+    {
+        // Rows of the image go bottom up.
+        const int cacheY = local.y + kernelSize - 1 - ky;
+        for(int kx = 0; kx < kernelSize; ++kx)
+        {
+            color += cache[cacheY][local.x + kx] * weights[ky * kernelSize + kx];
+        }
+    }
+
+    imageStore(targetImage, pixel, vec4(color, 1.0));
+}
@@ -0,0 +1,24 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2  TexCoords;
+
+// Should match maxSeparableKernelRadius in GLRenderer.cpp
+#define MAX_RADIUS 32
+
+uniform sampler2D screenTexture;
+uniform float     weights[2 * MAX_RADIUS + 1];
+uniform int       radius;
+// Texel step along the convolution axis.
+uniform vec2      direction;
+
+void main()
+{
+    vec3 color = vec3(0.0);
+    for(int i = -radius; i <= radius; ++i)
+    {
+        color += texture(screenTexture, TexCoords + direction * float(i)).rgb * weights[i + radius];
+    }
+
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,98 @@
+#include "CullingCache.h"
+
+#include "Scene/Components/Camera.h"
+#include "Scene/Components/SceneObject.h"
+
+namespace VSEngine {
+namespace SpatialSystem {
+
+CullingCache::CullingCache(float guardDistance, float guardAngle)
+    : m_guardDistance(guardDistance)
+    , m_guardAngle(guardAngle)
+{}
+
+bool CullingCache::IsValid(const Camera& camera) const
+{
+    if (!m_isValid)
+        return false;
+
+    // Projection changes (zoom, resize) invalidate the cache immediately.
+    if (camera.GetFoV() != m_fov || camera.GetAspectRatio() != m_aspectRatio ||
+        camera.GetZNear() != m_zNear || camera.GetZFar() != m_zFar)
+    {
+        return false;
+    }
+
+    // Half of the guard band is used as the threshold: the guard frustum apex is moved back
+    // by the whole guard distance, so the rest covers the widening of the moved camera frustum.
+    const glm::vec3 offset = camera.GetViewPosition() - m_position;
+    const float maxOffset = m_guardDistance * 0.5f;
+    if (glm::dot(offset, offset) > maxOffset * maxOffset)
+        return false;
+
+    const float cosAngle = glm::dot(camera.GetViewDirection(), m_direction);
+    const float minCosAngle = std::cos(VSUtils::DegreeToRadian(m_guardAngle * 0.5f));
+
+    return cosAngle >= minCosAngle;
+}
+
+VSUtils::Frustum CullingCache::MakeGuardFrustum(const Camera& camera) const
+{
+    const glm::vec3& direction = camera.GetViewDirection();
+
+    return VSUtils::Frustum(VSUtils::DegreeToRadian(camera.GetFoV() + m_guardAngle * 2.0f),
+                            camera.GetAspectRatio(),
+                            camera.GetZNear(),
+                            camera.GetZFar() + m_guardDistance * 2.0f,
+                            camera.GetViewPosition() - direction * m_guardDistance,
+                            direction,
+                            camera.GetUpDirection());
+}
+
+void CullingCache::Rebuild(const Camera& camera, const std::vector<SceneObject*>& guardObjects)
+{
+    m_position = camera.GetViewPosition();
+    m_direction = camera.GetViewDirection();
+    m_fov = camera.GetFoV();
+    m_aspectRatio = camera.GetAspectRatio();
+    m_zNear = camera.GetZNear();
+    m_zFar = camera.GetZFar();
+
+    m_coreObjects.clear();
+    m_edgeObjects.clear();
+
+    const VSUtils::Frustum& frustum = camera.GetFrustum();
+    for (SceneObject* pObject : guardObjects)
+    {
+        if (pObject == nullptr)
+            continue;
+
+        if (frustum.TestAABB(pObject->GetBoundingBox()) == VSUtils::IntersectionResult::Inside)
+        {
+            m_coreObjects.push_back(pObject);
+        }
+        else
+        {
+            m_edgeObjects.push_back(pObject);
+        }
+    }
+
+    m_isValid = true;
+}
+
+void CullingCache::GetVisibleObjects(const VSUtils::Frustum& frustum,
+                                     std::vector<SceneObject*>& objects) const
+{
+    objects.insert(objects.end(), m_coreObjects.begin(), m_coreObjects.end());
+
+    for (SceneObject* pObject : m_edgeObjects)
+    {
+        if (frustum.TestAABB(pObject->GetBoundingBox()) != VSUtils::IntersectionResult::Outside)
+        {
+            objects.push_back(pObject);
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Utils/GeometryUtils.h"
+
+namespace VSEngine {
+class Camera;
+class SceneObject;
+
+namespace SpatialSystem {
+
+constexpr float defaultGuardDistance = 2.0f;
+constexpr float defaultGuardAngle = 4.0f; // Degrees.
+
+// Keeps the result of culling against a guard-band frustum (the camera frustum enlarged
+// by the guard distance and angle). While the camera stays inside of the guard band
+// nothing outside of the cached set can become visible, so the octree isn't traversed.
+// Cached objects are split into core (fully inside of the camera frustum at culling time),
+// which are always reported, and edge ones, which are retested on every update.
+class CullingCache
+{
+public:
+    CullingCache(float guardDistance = defaultGuardDistance, float guardAngle = defaultGuardAngle);
+
+    // Checks if the camera is still inside of the guard band of the cached culling.
+    [[nodiscard]] bool IsValid(const Camera& camera) const;
+
+    // Frustum the octree should be culled with to rebuild the cache for the camera.
+    [[nodiscard]] VSUtils::Frustum MakeGuardFrustum(const Camera& camera) const;
+    // Takes the objects visible in the guard frustum of the camera.
+    void               Rebuild(const Camera& camera, const std::vector<SceneObject*>& guardObjects);
+    void               Invalidate() { m_isValid = false; }
+
+    // Appends core objects and edge objects which are visible in frustum.
+    void               GetVisibleObjects(const VSUtils::Frustum& frustum,
+                                         std::vector<SceneObject*>& objects) const;
+
+    [[nodiscard]] size_t GetCoreObjectsCount() const { return m_coreObjects.size(); }
+    [[nodiscard]] size_t GetEdgeObjectsCount() const { return m_edgeObjects.size(); }
+
+private:
+    std::vector<SceneObject*> m_coreObjects;
+    std::vector<SceneObject*> m_edgeObjects;
+
+    // Camera state at culling time.
+    glm::vec3                 m_position = glm::vec3(0.0f);
+    glm::vec3                 m_direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    float                     m_fov = 0.0f;
+    float                     m_aspectRatio = 0.0f;
+    float                     m_zNear = 0.0f;
+    float                     m_zFar = 0.0f;
+
+    float                     m_guardDistance;
+    float                     m_guardAngle;
+
+    bool                      m_isValid = false;
+};
+
+}
+}
@@ -1,5 +1,9 @@
 #include "Octree.h"
 
+#include "Core/System/JobSystem.h"
+
+#include <algorithm>
+
 namespace VSEngine {
 namespace SpatialSystem {
 
@@ -154,6 +158,80 @@ std::vector<SceneObject*> Node::GetInFrustum(const VSUtils::Frustum& frustum) co
     return objects;
 }
 
+void Node::GetInFrustums(const std::vector<VSUtils::Frustum>& frustums, ViewMask viewMask,
+                         ViewObjects& objects) const
+{
+    const ViewMask intersectMask = CollectInFrustums(frustums, viewMask, objects);
+    if (intersectMask == 0)
+        return;
+
+    for (size_t i = 0; i < octantCount; ++i)
+    {
+        if (m_children[i])
+        {
+            m_children[i]->GetInFrustums(frustums, intersectMask, objects);
+        }
+    }
+}
+
+ViewMask Node::CollectInFrustums(const std::vector<VSUtils::Frustum>& frustums, ViewMask viewMask,
+                                 ViewObjects& objects) const
+{
+    ViewMask insideMask = 0;
+    ViewMask intersectMask = 0;
+
+    const size_t viewsCount = frustums.size();
+    for (size_t view = 0; view < viewsCount; ++view)
+    {
+        const ViewMask viewBit = ViewMask(1) << view;
+        if ((viewMask & viewBit) == 0)
+            continue;
+
+        const VSUtils::IntersectionResult res = frustums[view].TestAABB(m_region);
+        if (res == VSUtils::IntersectionResult::Inside)
+        {
+            insideMask |= viewBit;
+        }
+        else if (res == VSUtils::IntersectionResult::Intersect)
+        {
+            intersectMask |= viewBit;
+        }
+    }
+
+    // Subtree is gathered once and shared by all the views which contain the node.
+    if (insideMask != 0)
+    {
+        const std::vector<SceneObject*> subObjects = GetSubtreeObjects();
+        for (size_t view = 0; view < viewsCount; ++view)
+        {
+            if (insideMask & (ViewMask(1) << view))
+            {
+                objects[view].insert(objects[view].end(), subObjects.begin(), subObjects.end());
+            }
+        }
+    }
+
+    if (intersectMask != 0)
+    {
+        for (SceneObject* pObject : m_objects)
+        {
+            if (pObject == nullptr)
+                continue;
+
+            for (size_t view = 0; view < viewsCount; ++view)
+            {
+                if ((intersectMask & (ViewMask(1) << view)) &&
+                    frustums[view].TestAABB(pObject->GetBoundingBox()) != VSUtils::IntersectionResult::Outside)
+                {
+                    objects[view].push_back(pObject);
+                }
+            }
+        }
+    }
+
+    return intersectMask;
+}
+
 std::vector<SceneObject*> Node::GetSubtreeObjects() const
 {
     std::vector<SceneObject*> objects(m_objects);
@@ -202,6 +280,54 @@ std::vector<SceneObject*> Octree::GetObjectsInside(const VSUtils::Frustum& frust
     return m_root->GetInFrustum(frustum);
 }
 
+void Octree::GetObjectsInside(const std::vector<VSUtils::Frustum>& frustums, ViewObjects& objects,
+                              System::JobSystem* pJobSystem) const
+{
+    const size_t viewsCount = std::min(frustums.size(), maxViewsCount);
+    objects.assign(frustums.size(), std::vector<SceneObject*>());
+    if (viewsCount == 0)
+        return;
+
+    const ViewMask allViewsMask = (viewsCount == maxViewsCount) ?
+        ~ViewMask(0) : (ViewMask(1) << viewsCount) - 1;
+
+    if (pJobSystem == nullptr)
+    {
+        m_root->GetInFrustums(frustums, allViewsMask, objects);
+        return;
+    }
+
+    const ViewMask intersectMask = m_root->CollectInFrustums(frustums, allViewsMask, objects);
+    if (intersectMask == 0)
+        return;
+
+    std::array<ViewObjects, octantCount> octantObjects;
+
+    System::JobCounter counter;
+    for (size_t i = 0; i < octantCount; ++i)
+    {
+        const Node* pChild = m_root->m_children[i];
+        if (pChild == nullptr)
+            continue;
+
+        octantObjects[i].resize(frustums.size());
+        pJobSystem->Schedule([pChild, &frustums, &octantObjects, intersectMask, i]()
+        {
+            pChild->GetInFrustums(frustums, intersectMask, octantObjects[i]);
+        }, counter);
+    }
+
+    pJobSystem->Wait(counter);
+
+    for (const ViewObjects& viewObjects : octantObjects)
+    {
+        for (size_t view = 0; view < viewObjects.size(); ++view)
+        {
+            objects[view].insert(objects[view].end(), viewObjects[view].begin(), viewObjects[view].end());
+        }
+    }
+}
+
 std::vector<SceneObject*> Octree::GetAllObjects() const
 {
     return m_root->GetSubtreeObjects();
@@ -6,11 +6,22 @@
 #include "Scene/Components/SceneObject.h"
 
 namespace VSEngine {
+namespace System {
+class JobSystem;
+}
+
 namespace SpatialSystem {
 
 static constexpr short octantCount = 8;
 static constexpr float minSize = 1.0f;
 
+// Bit per view for the traversal of multiple frustums at once.
+using ViewMask = unsigned int;
+static constexpr size_t maxViewsCount = sizeof(ViewMask) * 8;
+
+// Visible objects per view.
+using ViewObjects = std::vector<std::vector<VSEngine::SceneObject*>>;
+
 class Node
 {
 public:
@@ -36,6 +47,14 @@ public:
     // Get all the object from current node and subnodes;
     [[nodiscard]] std::vector<VSEngine::SceneObject*> GetSubtreeObjects() const;
 
+    // Same as GetInFrustum, but for every frustum of viewMask in a single traversal.
+    void GetInFrustums(const std::vector<VSUtils::Frustum>& frustums, ViewMask viewMask,
+                       ViewObjects& objects) const;
+    // Node part of the traversal above. Views containing the node get the whole subtree,
+    // intersecting ones get the visible objects of the node. Returns the mask of intersecting views.
+    ViewMask CollectInFrustums(const std::vector<VSUtils::Frustum>& frustums, ViewMask viewMask,
+                               ViewObjects& objects) const;
+
 public:
     std::vector<VSEngine::SceneObject*> m_objects;
     std::vector<VSEngine::SceneObject*> m_pendingObjects;
@@ -67,6 +86,10 @@ public:
 
     // Get all the objects which containing in or intersecting with frustum
     [[nodiscard]] std::vector<VSEngine::SceneObject*> GetObjectsInside(const VSUtils::Frustum& frustum) const;
+    // Culls all the frustums in one traversal, objects[i] gets the objects visible in frustums[i].
+    // Up to maxViewsCount frustums. Root octants are traversed as separate jobs if job system is provided.
+    void GetObjectsInside(const std::vector<VSUtils::Frustum>& frustums, ViewObjects& objects,
+                          System::JobSystem* pJobSystem) const;
     [[nodiscard]] std::vector<VSEngine::SceneObject*> GetAllObjects() const;
 
 private:
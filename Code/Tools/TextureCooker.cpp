@@ -0,0 +1,164 @@
+#include "Utils/DDSFile.h"
+#include "Utils/TextureCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace {
+struct CookOptions
+{
+    bool                 hasFormat = false;
+    VSUtils::BlockFormat format = VSUtils::BlockFormat::BC7;
+    bool                 isForced = false;
+};
+
+bool ParseFormat(const char* szName, VSUtils::BlockFormat& format)
+{
+    const VSUtils::BlockFormat formats[] = { VSUtils::BlockFormat::BC1, VSUtils::BlockFormat::BC3,
+                                             VSUtils::BlockFormat::BC4, VSUtils::BlockFormat::BC5,
+                                             VSUtils::BlockFormat::BC7 };
+    std::string name(szName);
+    std::transform(name.begin(), name.end(), name.begin(), [](char c) { return static_cast<char>(toupper(c)); });
+
+    for (VSUtils::BlockFormat candidate : formats)
+    {
+        if (name == VSUtils::GetBlockFormatName(candidate))
+        {
+            format = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool IsUpToDate(const char* szSourcePath, const std::string& cookedPath)
+{
+    std::error_code error;
+    const auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+    if (error)
+        return false;
+
+    const auto sourceTime = std::filesystem::last_write_time(szSourcePath, error);
+
+    return !error && sourceTime <= cookedTime;
+}
+
+bool CookFile(const char* szSourcePath, const CookOptions& options)
+{
+    const std::string cookedPath = VSUtils::GetCookedTexturePath(szSourcePath);
+    if (!options.isForced && IsUpToDate(szSourcePath, cookedPath))
+    {
+        printf("%s is up to date\n", cookedPath.c_str());
+        return true;
+    }
+
+    int width = 0, height = 0, channelsCount = 0;
+    unsigned char* pData = stbi_load(szSourcePath, &width, &height, &channelsCount, 0);
+    if (pData == nullptr)
+    {
+        fprintf(stderr, "Can't load %s: %s\n", szSourcePath, stbi_failure_reason());
+        return false;
+    }
+
+    const VSUtils::BlockFormat format = options.hasFormat ? options.format
+                                                          : VSUtils::GetDefaultBlockFormat(channelsCount);
+
+    VSUtils::CompressedTexture texture;
+    VSUtils::CookTexture(pData, width, height, channelsCount, format, texture);
+
+    stbi_image_free(pData);
+
+    if (!VSUtils::SaveDDS(cookedPath.c_str(), texture))
+        return false;
+
+    size_t cookedSize = 0;
+    for (const VSUtils::CompressedLevel& level : texture.levels)
+    {
+        cookedSize += level.data.size();
+    }
+
+    printf("%s: %dx%d, %d channels -> %s, %zu levels, %zu bytes\n", szSourcePath, width, height, channelsCount,
+           VSUtils::GetBlockFormatName(format), texture.levels.size(), cookedSize);
+
+    return true;
+}
+}
+
+// Compresses images to block formats with the complete mip chain. "wood.png" is cooked to "wood.png.dds",
+// which ResourceManager uploads instead of decoding the source image.
+// Usage: TextureCooker [--format bc1|bc3|bc4|bc5|bc7] [--force] image...
+// Format is picked from the channels count of each image by default, see GetDefaultBlockFormat.
+int main(int argc, char* argv[])
+{
+    CookOptions options;
+    std::vector<const char*> sourcePaths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            if (!ParseFormat(argv[++i], options.format))
+            {
+                fprintf(stderr, "Unknown format %s\n", argv[i]);
+                return 1;
+            }
+
+            options.hasFormat = true;
+        }
+        else if (strcmp(argv[i], "--force") == 0)
+        {
+            options.isForced = true;
+        }
+        else
+        {
+            sourcePaths.push_back(argv[i]);
+        }
+    }
+
+    if (sourcePaths.empty())
+    {
+        printf("Usage: TextureCooker [--format bc1|bc3|bc4|bc5|bc7] [--force] image...\n");
+        return 1;
+    }
+
+    // Images are independent, each worker takes the next one.
+    std::atomic<size_t> nextIndex(0);
+    std::atomic<size_t> failedCount(0);
+    auto cookFiles = [&]()
+    {
+        for (size_t i = nextIndex++; i < sourcePaths.size(); i = nextIndex++)
+        {
+            if (!CookFile(sourcePaths[i], options))
+            {
+                ++failedCount;
+            }
+        }
+    };
+
+    const size_t workersCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), sourcePaths.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < workersCount; ++i)
+    {
+        workers.emplace_back(cookFiles);
+    }
+
+    cookFiles();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+#include "DDSFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+namespace VSUtils {
+namespace {
+constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+    return static_cast<uint32_t>(static_cast<unsigned char>(a)) |
+           static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8 |
+           static_cast<uint32_t>(static_cast<unsigned char>(c)) << 16 |
+           static_cast<uint32_t>(static_cast<unsigned char>(d)) << 24;
+}
+
+constexpr uint32_t ddsMagic = MakeFourCC('D', 'D', 'S', ' ');
+
+constexpr uint32_t ddsFlagCaps = 0x1;
+constexpr uint32_t ddsFlagHeight = 0x2;
+constexpr uint32_t ddsFlagWidth = 0x4;
+constexpr uint32_t ddsFlagPixelFormat = 0x1000;
+constexpr uint32_t ddsFlagMipmapCount = 0x20000;
+constexpr uint32_t ddsFlagLinearSize = 0x80000;
+constexpr uint32_t ddsPixelFormatFourCC = 0x4;
+constexpr uint32_t ddsCapsComplex = 0x8;
+constexpr uint32_t ddsCapsTexture = 0x1000;
+constexpr uint32_t ddsCapsMipmap = 0x400000;
+constexpr uint32_t dx10ResourceTexture2D = 3;
+// Largest size GL implementations commonly support, bigger headers are taken for corrupt files.
+constexpr uint32_t maxTextureSize = 16384;
+
+// Values of DXGI_FORMAT.
+constexpr uint32_t dxgiFormatBC1 = 71;
+constexpr uint32_t dxgiFormatBC3 = 77;
+constexpr uint32_t dxgiFormatBC4 = 80;
+constexpr uint32_t dxgiFormatBC5 = 83;
+constexpr uint32_t dxgiFormatBC7 = 98;
+
+// Layouts of DDS_PIXELFORMAT, DDS_HEADER and DDS_HEADER_DXT10.
+struct DDSPixelFormat
+{
+    uint32_t size = sizeof(DDSPixelFormat);
+    uint32_t flags = 0;
+    uint32_t fourCC = 0;
+    uint32_t rgbBitCount = 0;
+    uint32_t bitMasks[4] = {};
+};
+
+struct DDSHeader
+{
+    uint32_t       size = sizeof(DDSHeader);
+    uint32_t       flags = 0;
+    uint32_t       height = 0;
+    uint32_t       width = 0;
+    uint32_t       pitchOrLinearSize = 0;
+    uint32_t       depth = 0;
+    uint32_t       mipMapCount = 0;
+    uint32_t       reserved1[11] = {};
+    DDSPixelFormat pixelFormat;
+    uint32_t       caps = 0;
+    uint32_t       caps2 = 0;
+    uint32_t       caps3 = 0;
+    uint32_t       caps4 = 0;
+    uint32_t       reserved2 = 0;
+};
+
+struct DDSHeaderDX10
+{
+    uint32_t dxgiFormat = 0;
+    uint32_t resourceDimension = dx10ResourceTexture2D;
+    uint32_t miscFlag = 0;
+    uint32_t arraySize = 1;
+    uint32_t miscFlags2 = 0;
+};
+
+static_assert(sizeof(DDSPixelFormat) == 32, "DDSPixelFormat doesn't match DDS_PIXELFORMAT");
+static_assert(sizeof(DDSHeader) == 124, "DDSHeader doesn't match DDS_HEADER");
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDSHeaderDX10 doesn't match DDS_HEADER_DXT10");
+
+uint32_t GetDXGIFormat(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return dxgiFormatBC1;
+    case BlockFormat::BC3: return dxgiFormatBC3;
+    case BlockFormat::BC4: return dxgiFormatBC4;
+    case BlockFormat::BC5: return dxgiFormatBC5;
+    case BlockFormat::BC7: return dxgiFormatBC7;
+    }
+
+    return 0;
+}
+
+bool GetBlockFormat(const DDSHeader& header, const DDSHeaderDX10* pHeaderDX10, BlockFormat& format)
+{
+    if (pHeaderDX10)
+    {
+        switch (pHeaderDX10->dxgiFormat)
+        {
+        case dxgiFormatBC1: format = BlockFormat::BC1; return true;
+        case dxgiFormatBC3: format = BlockFormat::BC3; return true;
+        case dxgiFormatBC4: format = BlockFormat::BC4; return true;
+        case dxgiFormatBC5: format = BlockFormat::BC5; return true;
+        case dxgiFormatBC7: format = BlockFormat::BC7; return true;
+        default: return false;
+        }
+    }
+
+    switch (header.pixelFormat.fourCC)
+    {
+    case MakeFourCC('D', 'X', 'T', '1'): format = BlockFormat::BC1; return true;
+    case MakeFourCC('D', 'X', 'T', '5'): format = BlockFormat::BC3; return true;
+    case MakeFourCC('A', 'T', 'I', '1'):
+    case MakeFourCC('B', 'C', '4', 'U'): format = BlockFormat::BC4; return true;
+    case MakeFourCC('A', 'T', 'I', '2'):
+    case MakeFourCC('B', 'C', '5', 'U'): format = BlockFormat::BC5; return true;
+    default: return false;
+    }
+}
+
+bool ReadHeaders(std::ifstream& file, const char* path, DDSDescription& description)
+{
+    uint32_t magic = 0;
+    DDSHeader header;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || magic != ddsMagic || header.size != sizeof(DDSHeader) || header.width == 0 || header.height == 0)
+    {
+        fprintf(stderr, "%s: isn't a DDS file\n", path);
+        return false;
+    }
+
+    DDSHeaderDX10 headerDX10;
+    const bool hasHeaderDX10 = (header.pixelFormat.flags & ddsPixelFormatFourCC) &&
+                               header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0');
+    if (hasHeaderDX10)
+    {
+        file.read(reinterpret_cast<char*>(&headerDX10), sizeof(headerDX10));
+    }
+
+    if (!file || !GetBlockFormat(header, hasHeaderDX10 ? &headerDX10 : nullptr, description.format) ||
+        (hasHeaderDX10 && (headerDX10.resourceDimension != dx10ResourceTexture2D || headerDX10.arraySize != 1)))
+    {
+        fprintf(stderr, "%s: only 2D textures of BC1, BC3, BC4, BC5 and BC7 formats are supported\n", path);
+        return false;
+    }
+
+    if (header.width > maxTextureSize || header.height > maxTextureSize)
+    {
+        fprintf(stderr, "%s: %ux%u texture is larger than %u\n", path, header.width, header.height, maxTextureSize);
+        return false;
+    }
+
+    // Count from the header can't exceed the complete chain.
+    uint32_t chainLength = 1;
+    for (uint32_t size = std::max(header.width, header.height); size > 1; size /= 2)
+    {
+        ++chainLength;
+    }
+
+    description.width = static_cast<int>(header.width);
+    description.height = static_cast<int>(header.height);
+    description.levelsCount = (header.flags & ddsFlagMipmapCount) ? std::clamp(header.mipMapCount, 1u, chainLength) : 1u;
+
+    return true;
+}
+}
+
+std::string GetCookedTexturePath(const char* sourcePath)
+{
+    return std::string(sourcePath) + ".dds";
+}
+
+bool SaveDDS(const char* path, const CompressedTexture& texture)
+{
+    if (texture.levels.empty())
+        return false;
+
+    const CompressedLevel& baseLevel = texture.levels.front();
+
+    DDSHeader header;
+    header.flags = ddsFlagCaps | ddsFlagHeight | ddsFlagWidth | ddsFlagPixelFormat |
+                   ddsFlagMipmapCount | ddsFlagLinearSize;
+    header.height = static_cast<uint32_t>(baseLevel.height);
+    header.width = static_cast<uint32_t>(baseLevel.width);
+    header.pitchOrLinearSize = static_cast<uint32_t>(baseLevel.data.size());
+    header.mipMapCount = static_cast<uint32_t>(texture.levels.size());
+    header.pixelFormat.flags = ddsPixelFormatFourCC;
+    header.pixelFormat.fourCC = MakeFourCC('D', 'X', '1', '0');
+    header.caps = ddsCapsTexture | ddsCapsComplex | ddsCapsMipmap;
+
+    DDSHeaderDX10 headerDX10;
+    headerDX10.dxgiFormat = GetDXGIFormat(texture.format);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        fprintf(stderr, "%s: can't be written\n", path);
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&ddsMagic), sizeof(ddsMagic));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+    for (const CompressedLevel& level : texture.levels)
+    {
+        file.write(reinterpret_cast<const char*>(level.data.data()), static_cast<std::streamsize>(level.data.size()));
+    }
+
+    return static_cast<bool>(file);
+}
+
+bool ReadDDSDescription(const char* path, DDSDescription& description)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    return ReadHeaders(file, path, description);
+}
+
+bool LoadDDS(const char* path, CompressedTexture& texture)
+{
+    return LoadDDSLevels(path, 0, SIZE_MAX, texture);
+}
+
+bool LoadDDSLevels(const char* path, size_t firstLevel, size_t levelsCount, CompressedTexture& texture)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    DDSDescription description;
+    if (!ReadHeaders(file, path, description))
+        return false;
+
+    if (firstLevel >= description.levelsCount)
+    {
+        fprintf(stderr, "%s: has no level %zu\n", path, firstLevel);
+        return false;
+    }
+
+    texture.format = description.format;
+    texture.levels.clear();
+
+    // Levels are stored from the largest one, the skipped ones are seeked over.
+    const size_t lastLevel = firstLevel + std::min(levelsCount, description.levelsCount - firstLevel);
+    std::streamoff offset = 0;
+    int width = description.width;
+    int height = description.height;
+    for (size_t levelIndex = 0; levelIndex < lastLevel && file; ++levelIndex)
+    {
+        const size_t levelSize = GetLevelSize(texture.format, width, height);
+        if (levelIndex < firstLevel)
+        {
+            offset += static_cast<std::streamoff>(levelSize);
+        }
+        else
+        {
+            if (levelIndex == firstLevel)
+            {
+                file.seekg(offset, std::ios::cur);
+            }
+
+            CompressedLevel& level = texture.levels.emplace_back();
+            level.width = width;
+            level.height = height;
+            level.data.resize(levelSize);
+            file.read(reinterpret_cast<char*>(level.data.data()), static_cast<std::streamsize>(levelSize));
+        }
+
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+
+    if (!file)
+    {
+        fprintf(stderr, "%s: is truncated\n", path);
+        texture.levels.clear();
+        return false;
+    }
+
+    return true;
+}
+
+}
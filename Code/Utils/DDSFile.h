@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "TextureCompression.h"
+
+namespace VSUtils {
+
+struct DDSDescription
+{
+    BlockFormat format = BlockFormat::BC1;
+    int         width = 0;
+    int         height = 0;
+    size_t      levelsCount = 0;
+};
+
+// Cooked texture of the source image, stored next to it: "wood.png" is cooked to "wood.png.dds".
+std::string GetCookedTexturePath(const char* sourcePath);
+
+// DDS files with the DX10 header. Legacy DXT1, DXT5, ATI1 and ATI2 headers are read as well.
+bool        SaveDDS(const char* path, const CompressedTexture& texture);
+// Silently returns false if the file doesn't exist, complains about the malformed ones.
+bool        LoadDDS(const char* path, CompressedTexture& texture);
+
+// Reads the headers only.
+bool        ReadDDSDescription(const char* path, DDSDescription& description);
+// Reads the levels from firstLevel on, at most levelsCount of them. Texture streaming loads the small levels
+// first and the large ones when they are needed.
+bool        LoadDDSLevels(const char* path, size_t firstLevel, size_t levelsCount, CompressedTexture& texture);
+
+}
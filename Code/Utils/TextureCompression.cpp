@@ -0,0 +1,524 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace VSUtils {
+namespace {
+constexpr int blockDimension = 4;
+constexpr int blockTexelsCount = blockDimension * blockDimension;
+
+// RGBA texels of a block in row order.
+using BlockTexels = std::array<std::array<unsigned char, 4>, blockTexelsCount>;
+
+// Interpolation weights of 4 bit BC7 indices, out of 64.
+constexpr int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+class BitWriter
+{
+public:
+    explicit BitWriter(unsigned char* pBlock)
+        : m_pBlock(pBlock)
+    {
+        std::memset(m_pBlock, 0, 16);
+    }
+
+    void Write(uint32_t value, int bitsCount)
+    {
+        for (int bit = 0; bit < bitsCount; ++bit, ++m_position)
+        {
+            if (value & (1u << bit))
+            {
+                m_pBlock[m_position / 8] |= static_cast<unsigned char>(1u << (m_position % 8));
+            }
+        }
+    }
+
+private:
+    unsigned char* m_pBlock = nullptr;
+    int            m_position = 0;
+};
+
+void ExpandToRGBA(const unsigned char* pData, int width, int height, int channelsCount,
+                  std::vector<unsigned char>& rgba)
+{
+    const size_t texelsCount = static_cast<size_t>(width) * height;
+    rgba.assign(texelsCount * 4, 0);
+
+    for (size_t texel = 0; texel < texelsCount; ++texel)
+    {
+        unsigned char* pTexel = &rgba[texel * 4];
+        pTexel[3] = 255;
+        for (int channel = 0; channel < channelsCount; ++channel)
+        {
+            pTexel[channel] = pData[texel * channelsCount + channel];
+        }
+    }
+}
+
+void ReadBlock(const unsigned char* pRgba, int width, int height, int blockX, int blockY, BlockTexels& texels)
+{
+    for (int y = 0; y < blockDimension; ++y)
+    {
+        const int sourceY = std::min(blockY * blockDimension + y, height - 1);
+        for (int x = 0; x < blockDimension; ++x)
+        {
+            const int sourceX = std::min(blockX * blockDimension + x, width - 1);
+            const unsigned char* pTexel = pRgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4;
+            std::memcpy(texels[y * blockDimension + x].data(), pTexel, 4);
+        }
+    }
+}
+
+// Ends of the principal axis of the first N channels, found by power iteration on the covariance.
+template<int N>
+void FindEndpoints(const BlockTexels& texels, float (&start)[N], float (&end)[N])
+{
+    float mean[N] = {};
+    for (const auto& texel : texels)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            mean[c] += texel[c];
+        }
+    }
+    for (int c = 0; c < N; ++c)
+    {
+        mean[c] /= blockTexelsCount;
+    }
+
+    float covariance[N][N] = {};
+    for (const auto& texel : texels)
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+            {
+                covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+            }
+        }
+    }
+
+    // Iteration starts from the covariance of the channel which varies most, it isn't orthogonal to the axis.
+    int widestChannel = 0;
+    for (int c = 1; c < N; ++c)
+    {
+        if (covariance[c][c] > covariance[widestChannel][widestChannel])
+        {
+            widestChannel = c;
+        }
+    }
+
+    // Flat block, every texel is the mean.
+    if (covariance[widestChannel][widestChannel] == 0.0f)
+    {
+        std::copy(mean, mean + N, start);
+        std::copy(mean, mean + N, end);
+        return;
+    }
+
+    float axis[N];
+    std::copy(covariance[widestChannel], covariance[widestChannel] + N, axis);
+
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float nextAxis[N] = {};
+        float length = 0.0f;
+        for (int i = 0; i < N; ++i)
+        {
+            for (int j = 0; j < N; ++j)
+            {
+                nextAxis[i] += covariance[i][j] * axis[j];
+            }
+            length = std::max(length, std::fabs(nextAxis[i]));
+        }
+
+        for (int c = 0; c < N; ++c)
+        {
+            axis[c] = nextAxis[c] / length;
+        }
+    }
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    float axisLengthSquared = 0.0f;
+    for (int c = 0; c < N; ++c)
+    {
+        axisLengthSquared += axis[c] * axis[c];
+    }
+
+    for (const auto& texel : texels)
+    {
+        float projection = 0.0f;
+        for (int c = 0; c < N; ++c)
+        {
+            projection += (texel[c] - mean[c]) * axis[c];
+        }
+        projection /= axisLengthSquared;
+
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    for (int c = 0; c < N; ++c)
+    {
+        start[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+        end[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+    }
+}
+
+template<int N, typename Palette>
+int FindClosestIndex(const std::array<unsigned char, 4>& texel, const Palette& palette, int paletteSize)
+{
+    int closestIndex = 0;
+    int closestDistance = INT32_MAX;
+    for (int index = 0; index < paletteSize; ++index)
+    {
+        int distance = 0;
+        for (int c = 0; c < N; ++c)
+        {
+            const int difference = static_cast<int>(texel[c]) - palette[index][c];
+            distance += difference * difference;
+        }
+
+        if (distance < closestDistance)
+        {
+            closestDistance = distance;
+            closestIndex = index;
+        }
+    }
+
+    return closestIndex;
+}
+
+uint16_t To565(const float (&color)[3])
+{
+    const uint16_t r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+    const uint16_t g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+    const uint16_t b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void From565(uint16_t value, int (&color)[3])
+{
+    const int r = (value >> 11) & 31;
+    const int g = (value >> 5) & 63;
+    const int b = value & 31;
+
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+void WriteLittleEndian(uint64_t value, int bytesCount, unsigned char* pDestination)
+{
+    for (int byte = 0; byte < bytesCount; ++byte)
+    {
+        pDestination[byte] = static_cast<unsigned char>(value >> (byte * 8));
+    }
+}
+
+// BC1 block in the four color mode, which is also the color part of BC3.
+void EncodeColorBlock(const BlockTexels& texels, unsigned char* pBlock)
+{
+    float start[3];
+    float end[3];
+    FindEndpoints<3>(texels, start, end);
+
+    uint16_t color0 = To565(end);
+    uint16_t color1 = To565(start);
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    int palette[4][3];
+    From565(color0, palette[0]);
+    From565(color1, palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    // Equal colors select the three color mode, index 0 is still the color.
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        for (int texel = 0; texel < blockTexelsCount; ++texel)
+        {
+            indices |= static_cast<uint32_t>(FindClosestIndex<3>(texels[texel], palette, 4)) << (texel * 2);
+        }
+    }
+
+    WriteLittleEndian(color0, 2, pBlock);
+    WriteLittleEndian(color1, 2, pBlock + 2);
+    WriteLittleEndian(indices, 4, pBlock + 4);
+}
+
+// BC4 block of one channel in the eight values mode, also the alpha of BC3 and each channel of BC5.
+void EncodeChannelBlock(const BlockTexels& texels, int channel, unsigned char* pBlock)
+{
+    int minValue = 255;
+    int maxValue = 0;
+    for (const auto& texel : texels)
+    {
+        minValue = std::min<int>(minValue, texel[channel]);
+        maxValue = std::max<int>(maxValue, texel[channel]);
+    }
+
+    int palette[8][1];
+    palette[0][0] = maxValue;
+    palette[1][0] = minValue;
+    for (int i = 1; i <= 6; ++i)
+    {
+        palette[i + 1][0] = ((7 - i) * maxValue + i * minValue + 3) / 7;
+    }
+
+    uint64_t indices = 0;
+    if (maxValue != minValue)
+    {
+        for (int texel = 0; texel < blockTexelsCount; ++texel)
+        {
+            std::array<unsigned char, 4> value = { texels[texel][channel], 0, 0, 0 };
+            indices |= static_cast<uint64_t>(FindClosestIndex<1>(value, palette, 8)) << (texel * 3);
+        }
+    }
+
+    pBlock[0] = static_cast<unsigned char>(maxValue);
+    pBlock[1] = static_cast<unsigned char>(minValue);
+    WriteLittleEndian(indices, 6, pBlock + 2);
+}
+
+// 7 bit endpoint channels share the lowest bit of the endpoint, picks the bit which fits it better.
+void QuantizeBC7Endpoint(const float (&endpoint)[4], int (&quantized)[4], int& pBit)
+{
+    int bestError = INT32_MAX;
+    for (int bit = 0; bit < 2; ++bit)
+    {
+        int candidate[4];
+        int error = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            candidate[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - bit) * 0.5f)), 0, 127);
+            const int difference = static_cast<int>(std::lround(endpoint[c])) - ((candidate[c] << 1) | bit);
+            error += difference * difference;
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            pBit = bit;
+            std::copy(candidate, candidate + 4, quantized);
+        }
+    }
+}
+
+// BC7 mode 6: one subset, RGBA endpoints with 7 bits and a p-bit, 4 bit indices.
+void EncodeBC7Block(const BlockTexels& texels, unsigned char* pBlock)
+{
+    float start[4];
+    float end[4];
+    FindEndpoints<4>(texels, start, end);
+
+    int endpoints[2][4];
+    int pBits[2];
+    QuantizeBC7Endpoint(start, endpoints[0], pBits[0]);
+    QuantizeBC7Endpoint(end, endpoints[1], pBits[1]);
+
+    int palette[16][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        const int value0 = (endpoints[0][c] << 1) | pBits[0];
+        const int value1 = (endpoints[1][c] << 1) | pBits[1];
+        for (int index = 0; index < 16; ++index)
+        {
+            palette[index][c] = ((64 - bc7Weights[index]) * value0 + bc7Weights[index] * value1 + 32) >> 6;
+        }
+    }
+
+    int indices[blockTexelsCount];
+    for (int texel = 0; texel < blockTexelsCount; ++texel)
+    {
+        indices[texel] = FindClosestIndex<4>(texels[texel], palette, 16);
+    }
+
+    // Highest bit of the first index is implicitly zero.
+    if (indices[0] & 8)
+    {
+        std::swap(endpoints[0], endpoints[1]);
+        std::swap(pBits[0], pBits[1]);
+        for (int& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer(pBlock);
+    writer.Write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        writer.Write(static_cast<uint32_t>(endpoints[0][c]), 7);
+        writer.Write(static_cast<uint32_t>(endpoints[1][c]), 7);
+    }
+    writer.Write(static_cast<uint32_t>(pBits[0]), 1);
+    writer.Write(static_cast<uint32_t>(pBits[1]), 1);
+
+    writer.Write(static_cast<uint32_t>(indices[0]), 3);
+    for (int texel = 1; texel < blockTexelsCount; ++texel)
+    {
+        writer.Write(static_cast<uint32_t>(indices[texel]), 4);
+    }
+}
+
+void EncodeBlock(const BlockTexels& texels, BlockFormat format, unsigned char* pBlock)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        EncodeColorBlock(texels, pBlock);
+        break;
+    case BlockFormat::BC3:
+        EncodeChannelBlock(texels, 3, pBlock);
+        EncodeColorBlock(texels, pBlock + 8);
+        break;
+    case BlockFormat::BC4:
+        EncodeChannelBlock(texels, 0, pBlock);
+        break;
+    case BlockFormat::BC5:
+        EncodeChannelBlock(texels, 0, pBlock);
+        EncodeChannelBlock(texels, 1, pBlock + 8);
+        break;
+    case BlockFormat::BC7:
+        EncodeBC7Block(texels, pBlock);
+        break;
+    }
+}
+
+void CompressRGBA(const unsigned char* pRgba, int width, int height, BlockFormat format,
+                  std::vector<unsigned char>& blocks)
+{
+    const int blocksX = (width + blockDimension - 1) / blockDimension;
+    const int blocksY = (height + blockDimension - 1) / blockDimension;
+    const size_t blockSize = GetBlockSize(format);
+
+    blocks.resize(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+    BlockTexels texels;
+    unsigned char* pBlock = blocks.data();
+    for (int blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for (int blockX = 0; blockX < blocksX; ++blockX, pBlock += blockSize)
+        {
+            ReadBlock(pRgba, width, height, blockX, blockY, texels);
+            EncodeBlock(texels, format, pBlock);
+        }
+    }
+}
+
+// Averages up to 2x2 texels, the last row and column of odd sizes are averaged with fewer.
+void Downsample(const std::vector<unsigned char>& source, int width, int height,
+                std::vector<unsigned char>& destination, int& nextWidth, int& nextHeight)
+{
+    nextWidth = std::max(width / 2, 1);
+    nextHeight = std::max(height / 2, 1);
+    destination.resize(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+    for (int y = 0; y < nextHeight; ++y)
+    {
+        const int y0 = y * 2;
+        const int y1 = std::min(y0 + 1, height - 1);
+        for (int x = 0; x < nextWidth; ++x)
+        {
+            const int x0 = x * 2;
+            const int x1 = std::min(x0 + 1, width - 1);
+            for (int c = 0; c < 4; ++c)
+            {
+                const int sum = source[(static_cast<size_t>(y0) * width + x0) * 4 + c] +
+                                source[(static_cast<size_t>(y0) * width + x1) * 4 + c] +
+                                source[(static_cast<size_t>(y1) * width + x0) * 4 + c] +
+                                source[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                destination[(static_cast<size_t>(y) * nextWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+}
+
+size_t GetBlockSize(BlockFormat format)
+{
+    return (format == BlockFormat::BC1 || format == BlockFormat::BC4) ? 8 : 16;
+}
+
+size_t GetLevelSize(BlockFormat format, int width, int height)
+{
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+const char* GetBlockFormatName(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return "BC1";
+    case BlockFormat::BC3: return "BC3";
+    case BlockFormat::BC4: return "BC4";
+    case BlockFormat::BC5: return "BC5";
+    case BlockFormat::BC7: return "BC7";
+    }
+
+    return "";
+}
+
+BlockFormat GetDefaultBlockFormat(int channelsCount)
+{
+    switch (channelsCount)
+    {
+    case 1:
+        return BlockFormat::BC4;
+    case 2:
+        return BlockFormat::BC5;
+    case 3:
+        return BlockFormat::BC1;
+    default:
+        return BlockFormat::BC7;
+    }
+}
+
+void CompressImage(const unsigned char* pData, int width, int height, int channelsCount,
+                   BlockFormat format, std::vector<unsigned char>& blocks)
+{
+    std::vector<unsigned char> rgba;
+    ExpandToRGBA(pData, width, height, channelsCount, rgba);
+    CompressRGBA(rgba.data(), width, height, format, blocks);
+}
+
+void CookTexture(const unsigned char* pData, int width, int height, int channelsCount,
+                 BlockFormat format, CompressedTexture& texture)
+{
+    texture.format = format;
+    texture.levels.clear();
+
+    std::vector<unsigned char> rgba;
+    std::vector<unsigned char> nextRgba;
+    ExpandToRGBA(pData, width, height, channelsCount, rgba);
+
+    while (true)
+    {
+        CompressedLevel& level = texture.levels.emplace_back();
+        level.width = width;
+        level.height = height;
+        CompressRGBA(rgba.data(), width, height, format, level.data);
+
+        if (width == 1 && height == 1)
+            break;
+
+        Downsample(rgba, width, height, nextRgba, width, height);
+        rgba.swap(nextRgba);
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace VSUtils {
+
+// Block compressed formats, 4x4 texels per block.
+enum class BlockFormat : char
+{
+    BC1,    // RGB, 8 bytes per block
+    BC3,    // RGBA with separate alpha, 16 bytes per block
+    BC4,    // R, 8 bytes per block
+    BC5,    // RG, 16 bytes per block
+    BC7     // RGBA, 16 bytes per block
+};
+
+struct CompressedLevel
+{
+    int                        width = 0;
+    int                        height = 0;
+    std::vector<unsigned char> data;
+};
+
+// Texture with the complete mip chain, down to 1x1.
+struct CompressedTexture
+{
+    BlockFormat                  format = BlockFormat::BC1;
+    std::vector<CompressedLevel> levels;
+};
+
+size_t      GetBlockSize(BlockFormat format);
+// Bytes of a level, partial blocks included.
+size_t      GetLevelSize(BlockFormat format, int width, int height);
+const char* GetBlockFormatName(BlockFormat format);
+// BC4 for one channel, BC5 for two, BC1 for RGB and BC7 for RGBA.
+BlockFormat GetDefaultBlockFormat(int channelsCount);
+
+// Channels of the image are stored to R, G, B and A in order, like GL_RED, GL_RG, GL_RGB and GL_RGBA
+// of uncompressed textures. Partial blocks at the right and the bottom edges repeat the edge texels.
+void        CompressImage(const unsigned char* pData, int width, int height, int channelsCount,
+                          BlockFormat format, std::vector<unsigned char>& blocks);
+// Builds the mip chain with a box filter and compresses every level.
+void        CookTexture(const unsigned char* pData, int width, int height, int channelsCount,
+                        BlockFormat format, CompressedTexture& texture);
+
+}